@@ -0,0 +1,238 @@
+/** @file
+    @brief Tool to check that ViveDriverHost's report path - driver callback,
+    update(), send - doesn't allocate once it's warmed up.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "Logger.h"
+#include "OSVRViveTracker.h"
+#include "StubPluginKit.h"
+
+// Library/third-party includes
+#include <openvr_driver.h>
+
+// Standard includes
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+
+/// @name Allocation counting
+/// Every allocation in the process goes through these replacements, which
+/// count them while counting is switched on.
+/// @{
+static std::atomic<bool> g_counting{false};
+static std::atomic<std::uint64_t> g_allocations{0};
+static std::atomic<std::uint64_t> g_bytes{0};
+
+static void *countedAlloc(std::size_t size) {
+    if (g_counting.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new(std::size_t size) {
+    if (auto p = countedAlloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t size) {
+    if (auto p = countedAlloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void *operator new(std::size_t size, std::nothrow_t const &) noexcept {
+    return countedAlloc(size);
+}
+void *operator new[](std::size_t size, std::nothrow_t const &) noexcept {
+    return countedAlloc(size);
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::nothrow_t const &) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p, std::nothrow_t const &) noexcept {
+    std::free(p);
+}
+/// @}
+
+using namespace osvr::vive;
+
+static const auto PREFIX = "[ViveAllocationCheck] ";
+
+struct Options {
+    /// Frames run before counting starts, for queues and the like to grow
+    /// to their working size.
+    std::size_t warmupFrames = 100;
+    /// Frames counted.
+    std::size_t frames = 10000;
+};
+
+static void usage(const char *argv0) {
+    std::cerr << "Usage: " << argv0
+              << " [--warmup <frames>] [--frames <frames>]\n\n"
+                 "Feeds an HMD's and two controllers' worth of driver "
+                 "callbacks through the\n"
+                 "plugin's report path, a server frame at a time, with OSVR "
+                 "stubbed out, and\n"
+                 "fails if anything allocates once the warm-up frames "
+                 "(default 100) are over.\n"
+              << std::endl;
+}
+
+static bool parseArgs(int argc, char *argv[], Options &opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool haveValue = i + 1 < argc;
+        if (arg == "--warmup" && haveValue) {
+            opts.warmupFrames = static_cast<std::size_t>(std::atol(argv[++i]));
+        } else if (arg == "--frames" && haveValue) {
+            opts.frames = static_cast<std::size_t>(std::atol(argv[++i]));
+        } else {
+            return false;
+        }
+    }
+    return opts.frames > 0;
+}
+
+/// Per 90 Hz server frame: the HMD's poses come in at about 1 kHz, the
+/// controllers' at about 250 Hz.
+static const std::size_t HMD_POSES_PER_FRAME = 11;
+static const std::size_t CONTROLLER_POSES_PER_FRAME = 3;
+/// A trigger press or release every this many frames.
+static const std::size_t FRAMES_PER_BUTTON = 45;
+static const std::uint32_t NUM_DEVICES = 3;
+
+static vr::DriverPose_t makePose(std::size_t n) {
+    vr::DriverPose_t pose;
+    std::memset(&pose, 0, sizeof(pose));
+    pose.qRotation.w = 1;
+    pose.qDriverFromHeadRotation.w = 1;
+    pose.qWorldFromDriverRotation.w = 1;
+    pose.vecPosition[0] = 0.001 * static_cast<double>(n % 1000);
+    pose.vecPosition[1] = 1.6;
+    pose.poseIsValid = true;
+    pose.deviceIsConnected = true;
+    pose.result = vr::TrackingResult_Running_OK;
+    return pose;
+}
+
+/// One frame's worth of driver callbacks, then the server's update.
+static void runFrame(ViveDriverHost &host, std::size_t frame) {
+    for (std::uint32_t dev = 0; dev < NUM_DEVICES; ++dev) {
+        auto poses = HMD_SENSOR == dev ? HMD_POSES_PER_FRAME
+                                       : CONTROLLER_POSES_PER_FRAME;
+        for (std::size_t i = 0; i < poses; ++i) {
+            host.TrackedDevicePoseUpdated(dev, makePose(frame * poses + i));
+        }
+        if (HMD_SENSOR == dev) {
+            continue;
+        }
+        if (frame % FRAMES_PER_BUTTON == 0) {
+            if ((frame / FRAMES_PER_BUTTON) % 2 == 0) {
+                host.TrackedDeviceButtonPressed(
+                    dev, vr::k_EButton_SteamVR_Trigger, 0);
+            } else {
+                host.TrackedDeviceButtonUnpressed(
+                    dev, vr::k_EButton_SteamVR_Trigger, 0);
+            }
+        }
+        vr::VRControllerAxis_t state;
+        state.x = static_cast<float>((frame % 100) * 0.01);
+        state.y = -state.x;
+        host.TrackedDeviceAxisUpdated(dev, 0, state);
+    }
+    stub_pluginkit::runUpdate();
+}
+
+int main(int argc, char *argv[]) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    PluginConfig config;
+    /// The devices are made up: don't remember their sensor IDs in a file.
+    config.sensorIdMapFile.clear();
+    DriverHostPtr host(new ViveDriverHost);
+    host->startWithoutDriver(config);
+    host->registerDevice(stub_pluginkit::getContext());
+    for (std::uint32_t dev = 0; dev < NUM_DEVICES; ++dev) {
+        host->activateReplayedDevice(
+            dev, HMD_SENSOR == dev ? DeviceRole::HMD : DeviceRole::Controller,
+            "ALLOC-" + std::to_string(dev));
+    }
+    /// Sends are only counted, so the stub doesn't allocate on our account.
+    stub_pluginkit::setKeepLatencies(false);
+
+    std::size_t frame = 0;
+    for (; frame < opts.warmupFrames; ++frame) {
+        runFrame(*host, frame);
+    }
+    /// Get the startup messages written before counting, since writing them
+    /// is none of the report path's doing.
+    Logger::instance().flush();
+    stub_pluginkit::resetStats();
+
+    std::size_t firstAllocatingFrame = 0;
+    std::size_t allocatingFrames = 0;
+    g_counting = true;
+    for (std::size_t i = 0; i < opts.frames; ++i, ++frame) {
+        auto before = g_allocations.load();
+        runFrame(*host, frame);
+        if (g_allocations.load() != before) {
+            if (0 == allocatingFrames) {
+                firstAllocatingFrame = frame;
+            }
+            allocatingFrames++;
+        }
+    }
+    g_counting = false;
+
+    using stub_pluginkit::SendType;
+    std::cout << PREFIX << opts.frames << " frames after " << opts.warmupFrames
+              << " of warm-up: "
+              << stub_pluginkit::getStats(SendType::Pose).count << " poses, "
+              << stub_pluginkit::getStats(SendType::Button).count
+              << " buttons, "
+              << stub_pluginkit::getStats(SendType::Analog).count
+              << " analogs sent" << std::endl;
+    if (allocatingFrames > 0) {
+        std::cout << PREFIX << "FAIL: " << g_allocations.load()
+                  << " allocations (" << g_bytes.load() << " bytes) in "
+                  << allocatingFrames << " frames, starting with frame "
+                  << firstAllocatingFrame << std::endl;
+        return 1;
+    }
+    std::cout << PREFIX << "No allocations." << std::endl;
+    return 0;
+}
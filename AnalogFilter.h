@@ -0,0 +1,114 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_AnalogFilter_h_GUID_0F7D3B96_C28A_4E15_B4A9_68E1C5D20F73
+#define INCLUDED_AnalogFilter_h_GUID_0F7D3B96_C28A_4E15_B4A9_68E1C5D20F73
+
+// Internal Includes
+#include "SensorChannels.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+namespace osvr {
+namespace vive {
+
+    /// Screens analog values from the driver before they're queued: values
+    /// within the deadband of zero are snapped to zero, and a value is only
+    /// worth sending if it differs from the last one sent on its channel by
+    /// more than the change threshold. The driver reports the trackpad and
+    /// trigger continuously, even with a thumb just resting on the trackpad,
+    /// so this keeps most of those reports from ever taking the queue's
+    /// mutex.
+    ///
+    /// The thresholds are set before the driver starts; the per-channel
+    /// state may be used from any thread. Several driver threads may report
+    /// the same channel: trySend() checks and records a value in one atomic
+    /// step, so only one of a racing pair of equal values gets through.
+    class AnalogFilter {
+      public:
+        AnalogFilter() { resetAll(); }
+
+        void configure(double deadband, double changeThreshold) {
+            deadband_ = deadband;
+            changeThreshold_ = changeThreshold;
+        }
+
+        double applyDeadband(double value) const {
+            return std::abs(value) <= deadband_ ? 0. : value;
+        }
+
+        /// Whether value (already through applyDeadband()) should be sent:
+        /// if so, it's recorded as the last value sent.
+        bool trySend(OSVR_ChannelCount channel, double value) {
+            if (!(channel < ANALOG_CAPACITY)) {
+                return true;
+            }
+            auto &lastSent = lastSent_[channel];
+            auto last = lastSent.load(std::memory_order_relaxed);
+            do {
+                /// Never-sent channels hold NaN, so this passes.
+                if (std::abs(value - last) <= changeThreshold_) {
+                    return false;
+                }
+            } while (!lastSent.compare_exchange_weak(
+                last, value, std::memory_order_relaxed));
+            return true;
+        }
+
+        /// Note a value that's being sent without going through trySend().
+        void sent(OSVR_ChannelCount channel, double value) {
+            if (channel < ANALOG_CAPACITY) {
+                lastSent_[channel].store(value, std::memory_order_relaxed);
+            }
+        }
+
+        /// Forget the last value sent, so the next one offered to trySend()
+        /// goes through, even if a trySend() is racing with this.
+        void reset(OSVR_ChannelCount channel) {
+            sent(channel, std::numeric_limits<double>::quiet_NaN());
+        }
+
+        void resetAll() {
+            for (OSVR_ChannelCount i = 0; i < ANALOG_CAPACITY; ++i) {
+                reset(i);
+            }
+        }
+
+      private:
+        double deadband_ = 0.;
+        double changeThreshold_ = 0.;
+        std::array<std::atomic<double>, ANALOG_CAPACITY> lastSent_;
+    };
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_AnalogFilter_h_GUID_0F7D3B96_C28A_4E15_B4A9_68E1C5D20F73
@@ -0,0 +1,483 @@
+/** @file
+    @brief Microbenchmarks of the plugin's hot paths, with results written as
+    JSON so they can be compared between versions.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "ChaperoneData.h"
+#include "PoseConversion.h"
+#include "PoseHistory.h"
+#include "QuickProcessingDeque.h"
+#include "RGBPoints.h"
+#include "Timestamp.h"
+
+// Library/third-party includes
+#include <boost/filesystem.hpp>
+#include <json/value.h>
+#include <json/writer.h>
+#include <openvr_driver.h>
+
+// Standard includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace osvr::vive;
+namespace fs = boost::filesystem;
+
+static const auto PREFIX = "[ViveBenchmarks] ";
+
+/// Bumped whenever a benchmark changes in a way that makes its results
+/// incomparable with earlier ones.
+static const int SUITE_VERSION = 1;
+
+struct Options {
+    /// Only run benchmarks whose name contains this.
+    std::string filter;
+    /// Recorded in the output, to tell runs apart: a version, say.
+    std::string label;
+    /// Where to write the JSON; stdout if empty.
+    std::string outputFile;
+    /// Timed runs of each benchmark, after calibration.
+    std::size_t repetitions = 10;
+    /// Each timed run is made long enough to take at least this long.
+    double minRunSeconds = 0.05;
+};
+
+static void usage(const char *argv0) {
+    std::cerr << "Usage: " << argv0
+              << " [--filter <substring>] [--label <text>] "
+                 "[--repetitions <n>] [--min-time <seconds>] "
+                 "[--output <file>]\n\n"
+                 "Runs microbenchmarks of the plugin's hot paths and writes "
+                 "the results as JSON\n"
+                 "(to stdout, unless an output file is given).\n"
+              << std::endl;
+}
+
+static bool parseArgs(int argc, char *argv[], Options &opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool haveValue = i + 1 < argc;
+        if (arg == "--filter" && haveValue) {
+            opts.filter = argv[++i];
+        } else if (arg == "--label" && haveValue) {
+            opts.label = argv[++i];
+        } else if (arg == "--output" && haveValue) {
+            opts.outputFile = argv[++i];
+        } else if (arg == "--repetitions" && haveValue) {
+            auto n = std::atoi(argv[++i]);
+            if (n < 1) {
+                return false;
+            }
+            opts.repetitions = static_cast<std::size_t>(n);
+        } else if (arg == "--min-time" && haveValue) {
+            opts.minRunSeconds = std::atof(argv[++i]);
+            if (!(opts.minRunSeconds > 0)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Keeps results alive so the work can't be optimized away.
+static volatile std::uint64_t g_sink;
+
+/// Times a benchmark body, which does one operation per call (and is passed
+/// the call's index, to vary its input).
+class Runner {
+  public:
+    explicit Runner(Options const &opts) : opts_(opts) {}
+
+    /// @param itemsPerOp What one operation processes (reports, bytes...),
+    /// for a throughput figure; 0 if that doesn't apply.
+    /// @param itemName What those items are, for the output.
+    void run(std::string const &name, std::function<void(std::size_t)> op,
+             std::size_t itemsPerOp = 0, const char *itemName = "items") {
+        if (name.find(opts_.filter) == std::string::npos) {
+            return;
+        }
+        std::cerr << PREFIX << "Running " << name << std::endl;
+
+        /// Grow the run until it's long enough to time reliably, which
+        /// doubles as a warm-up.
+        std::size_t iterations = 1;
+        while (timeRun(op, iterations) < opts_.minRunSeconds &&
+               iterations < (std::size_t(1) << 30)) {
+            iterations *= 2;
+        }
+
+        std::vector<double> nsPerOp;
+        for (std::size_t rep = 0; rep < opts_.repetitions; ++rep) {
+            nsPerOp.push_back(timeRun(op, iterations) * 1e9 / iterations);
+        }
+        std::sort(nsPerOp.begin(), nsPerOp.end());
+        double sum = 0;
+        for (auto ns : nsPerOp) {
+            sum += ns;
+        }
+        auto mean = sum / nsPerOp.size();
+        double sumSq = 0;
+        for (auto ns : nsPerOp) {
+            sumSq += (ns - mean) * (ns - mean);
+        }
+        auto median = nsPerOp[nsPerOp.size() / 2];
+
+        Json::Value result(Json::objectValue);
+        result["name"] = name;
+        result["iterations"] = static_cast<Json::UInt64>(iterations);
+        result["repetitions"] = static_cast<Json::UInt64>(nsPerOp.size());
+        result["ns_per_op_min"] = nsPerOp.front();
+        result["ns_per_op_median"] = median;
+        result["ns_per_op_mean"] = mean;
+        result["ns_per_op_max"] = nsPerOp.back();
+        result["ns_per_op_stddev"] = std::sqrt(sumSq / nsPerOp.size());
+        if (itemsPerOp > 0) {
+            result[std::string(itemName) + "_per_op"] =
+                static_cast<Json::UInt64>(itemsPerOp);
+            result[std::string(itemName) + "_per_second"] =
+                itemsPerOp * 1e9 / median;
+        }
+        results_.append(result);
+    }
+
+    Json::Value const &getResults() const { return results_; }
+
+  private:
+    static double timeRun(std::function<void(std::size_t)> const &op,
+                          std::size_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; ++i) {
+            op(i);
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             start)
+            .count();
+    }
+
+    Options const &opts_;
+    Json::Value results_{Json::arrayValue};
+};
+
+/// Poses that vary the way real ones do, so the conversion doesn't get to
+/// work on the same numbers over and over.
+static std::vector<vr::DriverPose_t> makePoses(std::size_t count) {
+    std::vector<vr::DriverPose_t> poses(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto &pose = poses[i];
+        std::memset(&pose, 0, sizeof(pose));
+        auto angle = 0.1 * i;
+        auto setQuat = [](vr::HmdQuaternion_t &q, double a) {
+            q.w = std::cos(a / 2);
+            q.x = 0;
+            q.y = std::sin(a / 2);
+            q.z = 0;
+        };
+        setQuat(pose.qRotation, angle);
+        setQuat(pose.qDriverFromHeadRotation, 0.05);
+        setQuat(pose.qWorldFromDriverRotation, 1.2);
+        for (int axis = 0; axis < 3; ++axis) {
+            pose.vecPosition[axis] = std::sin(angle + axis);
+            pose.vecDriverFromHeadTranslation[axis] = 0.01 * axis;
+            pose.vecWorldFromDriverTranslation[axis] = 0.5 + axis;
+        }
+        pose.poseIsValid = true;
+        pose.deviceIsConnected = true;
+        pose.result = vr::TrackingResult_Running_OK;
+    }
+    return poses;
+}
+
+/// What a device's tracking thread queues for the main thread: the same
+/// shape as the driver host's TrackingReport, without needing PluginKit.
+struct QueuedPose {
+    bool isUniverseChange = false;
+    std::uint64_t newUniverse;
+    Timestamp timestamp;
+    std::uint32_t sensor;
+    vr::DriverPose_t report;
+};
+
+/// Reports queued between two main-loop updates: an HMD and two controllers
+/// at their usual rates over a couple of milliseconds, give or take.
+static const std::size_t REPORTS_PER_DRAIN = 8;
+
+static void benchmarkQueue(Runner &runner) {
+    auto poses = makePoses(REPORTS_PER_DRAIN);
+    std::mutex mutex;
+    QuickProcessingDeque<QueuedPose> queue;
+    runner.run("QuickProcessingDeque/submitAndDrain",
+               [&](std::size_t) {
+                   for (std::size_t i = 0; i < REPORTS_PER_DRAIN; ++i) {
+                       QueuedPose report;
+                       report.timestamp = Timestamp::now();
+                       report.sensor = static_cast<std::uint32_t>(i % 3);
+                       report.report = poses[i];
+                       std::lock_guard<std::mutex> lock(mutex);
+                       queue.submitNew(std::move(report), lock);
+                   }
+                   {
+                       std::lock_guard<std::mutex> lock(mutex);
+                       queue.grabItems(lock);
+                   }
+                   std::uint64_t total = 0;
+                   for (auto const &report : queue.accessWorkItems()) {
+                       total += report.sensor;
+                   }
+                   g_sink = total;
+               },
+               REPORTS_PER_DRAIN, "reports");
+}
+
+static void benchmarkPoseConversion(Runner &runner) {
+    static const std::size_t NUM_POSES = 64;
+    auto poses = makePoses(NUM_POSES);
+    using namespace Eigen;
+    Isometry3d universeXform =
+        Translation3d(0.3, 0, -1.2) * AngleAxisd(0.7, Vector3d::UnitY());
+    Quaterniond universeRotation(AngleAxisd(0.7, Vector3d::UnitY()));
+    runner.run("convertAndSendTracker/poseFromDriver", [&](std::size_t i) {
+        auto pose = poseFromDriver(poses[i % NUM_POSES], universeXform,
+                                   universeRotation);
+        std::uint64_t bits;
+        std::memcpy(&bits, &pose.translation.data[0], sizeof(bits));
+        g_sink = bits;
+    });
+}
+
+/// A full history of 1 kHz samples, queried at times spread across it, as
+/// a late-latching client would.
+static void benchmarkPoseHistory(Runner &runner) {
+    static const std::size_t NUM_QUERIES = 64;
+    auto start = Timestamp::now();
+    PoseHistory history;
+    for (std::size_t i = 0; i < PoseHistory::CAPACITY; ++i) {
+        PoseSample sample;
+        sample.time = start.offsetBy(0.001 * static_cast<double>(i));
+        sample.position =
+            Eigen::Vector3d(0.001 * static_cast<double>(i), 1.6, 0);
+        sample.orientation = Eigen::Quaterniond(Eigen::AngleAxisd(
+            0.01 * static_cast<double>(i), Eigen::Vector3d::UnitY()));
+        sample.velocity = Eigen::Vector3d(1, 0, 0);
+        sample.angularVelocity = Eigen::Vector3d(0, 10, 0);
+        history.add(sample);
+    }
+    auto span = history.newest().time.secondsSince(history.oldest().time);
+    runner.run("PoseHistory/poseAt", [&](std::size_t i) {
+        auto t = start.offsetBy(span * static_cast<double>(i % NUM_QUERIES) /
+                                NUM_QUERIES);
+        PoseSample out;
+        history.poseAt(t, out);
+        std::uint64_t bits;
+        std::memcpy(&bits, &out.position[0], sizeof(bits));
+        g_sink = bits;
+    });
+    auto next = history.newest();
+    runner.run("PoseHistory/add", [&](std::size_t) {
+        next.time = next.time.offsetBy(0.001);
+        history.add(next);
+        g_sink = history.size();
+    });
+}
+
+/// Synthetic chaperone_info universes: many more of them, with far more
+/// detailed bounds, than a real room setup leaves behind.
+static const std::size_t NUM_UNIVERSES = 200;
+static const std::size_t BASES_PER_UNIVERSE = 2;
+static const std::size_t WALLS_PER_UNIVERSE = 64;
+
+static std::string baseSerial(std::size_t universe, std::size_t base) {
+    std::ostringstream os;
+    os << "LHB-" << std::hex << (0x1000 + universe * BASES_PER_UNIVERSE + base);
+    return os.str();
+}
+
+static std::size_t writeChaperoneInfo(fs::path const &dir) {
+    Json::Value root(Json::objectValue);
+    root["jsonid"] = "chaperone_info";
+    root["version"] = 3;
+    auto &universes = root["universes"] = Json::Value(Json::arrayValue);
+    for (std::size_t u = 0; u < NUM_UNIVERSES; ++u) {
+        Json::Value univ(Json::objectValue);
+        univ["universeID"] = std::to_string(1000000000ull + u * 7919ull);
+        Json::Value bounds(Json::arrayValue);
+        for (std::size_t w = 0; w < WALLS_PER_UNIVERSE; ++w) {
+            Json::Value wall(Json::arrayValue);
+            for (int corner = 0; corner < 4; ++corner) {
+                Json::Value pt(Json::arrayValue);
+                pt.append(std::cos(w * 0.1 + corner) * 2.);
+                pt.append(corner < 2 ? 0. : 2.4);
+                pt.append(std::sin(w * 0.1 + corner) * 2.);
+                wall.append(pt);
+            }
+            bounds.append(wall);
+        }
+        univ["collision_bounds"] = bounds;
+        Json::Value standing(Json::objectValue);
+        standing["yaw"] = 0.01 * u;
+        standing["translation"] = Json::Value(Json::arrayValue);
+        for (int axis = 0; axis < 3; ++axis) {
+            standing["translation"].append(0.1 * axis + 0.001 * u);
+        }
+        univ["standing"] = standing;
+        Json::Value trackers(Json::arrayValue);
+        for (std::size_t b = 0; b < BASES_PER_UNIVERSE; ++b) {
+            Json::Value tracker(Json::objectValue);
+            tracker["serial"] = baseSerial(u, b);
+            tracker["angOffset"] = Json::Value(Json::arrayValue);
+            trackers.append(tracker);
+        }
+        univ["trackers"] = trackers;
+        universes.append(univ);
+    }
+    auto contents = Json::StyledWriter().write(root);
+    std::ofstream os((dir / "chaperone_info.vrchap").string(),
+                     std::ios::out | std::ios::binary);
+    os << contents;
+    return contents.size();
+}
+
+static void benchmarkChaperone(Runner &runner) {
+    auto dir = fs::temp_directory_path() /
+               fs::unique_path("vive-benchmarks-%%%%-%%%%-%%%%");
+    fs::create_directories(dir);
+    auto bytes = writeChaperoneInfo(dir);
+    auto dirName = dir.string();
+
+    ChaperoneData chaperone(dirName);
+    if (!chaperone.valid() ||
+        chaperone.getNumberOfKnownUniverses() != NUM_UNIVERSES) {
+        std::cerr << PREFIX << "Synthetic chaperone data didn't load: "
+                  << chaperone.getMessage() << std::endl;
+    } else {
+        runner.run("ChaperoneData/parse",
+                   [&](std::size_t) {
+                       ChaperoneData data(dirName);
+                       g_sink = data.getNumberOfKnownUniverses();
+                   },
+                   bytes, "bytes");
+
+        /// What the driver reports for a device: one of a universe's bases,
+        /// and one it hasn't seen before. Take them from the middle of the
+        /// list, so the search doesn't get lucky.
+        ChaperoneData::BaseStationSerials bases = {
+            baseSerial(NUM_UNIVERSES / 2, 0), "LHB-UNKNOWN"};
+        runner.run("ChaperoneData/guessUniverseIdFromBaseStations",
+                   [&](std::size_t) {
+                       g_sink =
+                           chaperone.guessUniverseIdFromBaseStations(bases);
+                   },
+                   NUM_UNIVERSES, "universes");
+    }
+
+    boost::system::error_code ec;
+    fs::remove_all(dir, ec);
+}
+
+/// The sampling resolution ViveDisplayExtractor uses for each eye.
+static const std::size_t MESH_SAMPLES_PER_SIDE = 33;
+
+static void addMeshSamples(RGBPoints &mesh) {
+    auto step = 1.f / (MESH_SAMPLES_PER_SIDE - 1);
+    for (auto eye : {RGBPoints::Eye::Left, RGBPoints::Eye::Right}) {
+        for (std::size_t v = 0; v < MESH_SAMPLES_PER_SIDE; ++v) {
+            for (std::size_t u = 0; u < MESH_SAMPLES_PER_SIDE; ++u) {
+                RGBPoints::Point2 in = {{u * step, v * step}};
+                RGBPoints::Point2 r = {{in[0] * 0.98f, in[1] * 0.98f}};
+                RGBPoints::Point2 g = {{in[0] * 0.99f, in[1] * 0.99f}};
+                mesh.addSample(eye, in, r, g, in);
+            }
+        }
+    }
+}
+
+static void benchmarkMesh(Runner &runner) {
+    static const auto SAMPLES =
+        2 * MESH_SAMPLES_PER_SIDE * MESH_SAMPLES_PER_SIDE;
+    runner.run("RGBPoints/addSamples",
+               [&](std::size_t) {
+                   RGBPoints mesh;
+                   addMeshSamples(mesh);
+               },
+               SAMPLES, "samples");
+
+    RGBPoints mesh;
+    addMeshSamples(mesh);
+    runner.run("RGBPoints/getSeparateFile",
+               [&](std::size_t) { g_sink = mesh.getSeparateFile().size(); },
+               SAMPLES, "samples");
+}
+
+int main(int argc, char *argv[]) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Runner runner(opts);
+    benchmarkQueue(runner);
+    benchmarkPoseConversion(runner);
+    benchmarkPoseHistory(runner);
+    benchmarkChaperone(runner);
+    benchmarkMesh(runner);
+
+    Json::Value root(Json::objectValue);
+    root["suite"] = "ViveBenchmarks";
+    root["suiteVersion"] = SUITE_VERSION;
+    root["label"] = opts.label;
+#ifdef NDEBUG
+    root["optimized"] = true;
+#else
+    root["optimized"] = false;
+#endif
+    root["benchmarks"] = runner.getResults();
+    auto output = Json::StyledWriter().write(root);
+
+    if (opts.outputFile.empty()) {
+        std::cout << output;
+        return 0;
+    }
+    std::ofstream os(opts.outputFile);
+    if (!(os << output)) {
+        std::cerr << PREFIX << "Could not write results to "
+                  << opts.outputFile << std::endl;
+        return 1;
+    }
+    std::cerr << PREFIX << "Results written to " << opts.outputFile
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,365 @@
+/** @file
+    @brief Benchmark counting, with the CPU's performance counters, the cache
+    misses the report path causes while driver threads report flat out.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "CacheLine.h"
+#include "Logger.h"
+#include "OSVRViveTracker.h"
+#include "StubPluginKit.h"
+
+// Library/third-party includes
+#include <openvr_driver.h>
+
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace osvr::vive;
+
+static const auto PREFIX = "[ViveCacheBenchmark] ";
+
+struct Options {
+    double seconds = 2.;
+    /// Driver threads, each reporting for two devices.
+    std::size_t producerThreads = 2;
+    /// A model-specific event to count as well, as perf's raw config: for
+    /// instance a cross-core snoop hitting a modified line (HITM).
+    std::uint64_t rawEvent = 0;
+};
+
+static void usage(const char *argv0) {
+    std::cerr
+        << "Usage: " << argv0
+        << " [--seconds <s>] [--threads <n>] [--raw <hex event>]\n\n"
+           "Pins each driver thread and the main thread to cores of their\n"
+           "own, has the driver threads call the plugin's pose and axis\n"
+           "callbacks flat out while the main thread runs updates, and\n"
+           "counts cycles and cache misses per report sent. The same is\n"
+           "measured for two counters written by two threads, in one cache\n"
+           "line and then a line apart, to show what false sharing costs on\n"
+           "this machine. Compare runs against a build from before a layout\n"
+           "change. Linux only; needs perf_event_paranoid of 2 or less.\n"
+           "  --seconds   Length of each measurement (default 2)\n"
+           "  --threads   Driver threads (default 2)\n"
+           "  --raw       Also count this raw PMU event, for instance\n"
+           "              MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM (0x4d2 on recent\n"
+           "              Intel cores) for lines taken from another core\n"
+        << std::endl;
+}
+
+static bool parseArgs(int argc, char *argv[], Options &opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool haveValue = i + 1 < argc;
+        if (arg == "--seconds" && haveValue) {
+            opts.seconds = std::atof(argv[++i]);
+        } else if (arg == "--threads" && haveValue) {
+            opts.producerThreads =
+                static_cast<std::size_t>(std::atol(argv[++i]));
+        } else if (arg == "--raw" && haveValue) {
+            opts.rawEvent = std::strtoull(argv[++i], nullptr, 16);
+        } else {
+            return false;
+        }
+    }
+    return opts.seconds > 0 && opts.producerThreads > 0 &&
+           opts.producerThreads * 2 <= MAX_SENSORS;
+}
+
+/// Counts events for the calling thread and every thread it starts while
+/// counting, the way `perf stat` does.
+class Counters {
+  public:
+    explicit Counters(std::uint64_t rawEvent) {
+        add("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        add("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        add("L1D misses", PERF_TYPE_HW_CACHE,
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+        add("LLC misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        if (rawEvent) {
+            add("raw event", PERF_TYPE_RAW, rawEvent);
+        }
+    }
+
+    ~Counters() {
+        for (auto const &counter : counters_) {
+            close(counter.fd);
+        }
+    }
+
+    Counters(Counters const &) = delete;
+    Counters &operator=(Counters const &) = delete;
+
+    bool available() const { return !counters_.empty(); }
+    std::string const &getError() const { return error_; }
+
+    void start() {
+        for (auto const &counter : counters_) {
+            ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    void stop() {
+        for (auto const &counter : counters_) {
+            ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    /// Call after the threads started while counting have been joined:
+    /// their counts are only added in as they exit.
+    void print(std::uint64_t perWhat, const char *what) const {
+        std::cout << PREFIX << "  per " << what << ":";
+        for (auto const &counter : counters_) {
+            std::uint64_t value = 0;
+            if (read(counter.fd, &value, sizeof(value)) != sizeof(value)) {
+                continue;
+            }
+            std::cout << "  " << counter.name << " " << std::fixed
+                      << std::setprecision(3)
+                      << static_cast<double>(value) / perWhat;
+        }
+        std::cout << std::endl;
+    }
+
+  private:
+    void add(const char *name, std::uint32_t type, std::uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        auto fd = static_cast<int>(
+            syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd < 0) {
+            if (error_.empty()) {
+                auto err = errno;
+                error_ = std::string("could not count ") + name + ": " +
+                         std::strerror(err);
+                if (EACCES == err || EPERM == err) {
+                    error_ += ", see /proc/sys/kernel/perf_event_paranoid";
+                }
+            }
+            return;
+        }
+        counters_.push_back(Counter{name, fd});
+    }
+
+    struct Counter {
+        const char *name;
+        int fd;
+    };
+    std::vector<Counter> counters_;
+    std::string error_;
+};
+
+static unsigned g_numCpus = 1;
+
+/// Each thread gets a core of its own, as far as there are enough.
+static void pinCurrentThread(std::size_t n) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(n % g_numCpus, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+}
+
+static const std::size_t POSES_PER_AXIS = 4;
+
+static vr::DriverPose_t makePose(std::size_t seq) {
+    vr::DriverPose_t pose;
+    std::memset(&pose, 0, sizeof(pose));
+    pose.qRotation.w = 1;
+    pose.qDriverFromHeadRotation.w = 1;
+    pose.qWorldFromDriverRotation.w = 1;
+    pose.vecPosition[0] = static_cast<double>(seq);
+    pose.poseIsValid = true;
+    pose.deviceIsConnected = true;
+    pose.result = vr::TrackingResult_Running_OK;
+    return pose;
+}
+
+/// Driver threads reporting flat out while the main thread sends.
+static void benchmarkReportPath(Options const &opts, Counters &counters) {
+    auto numDevices = static_cast<std::uint32_t>(opts.producerThreads * 2);
+    PluginConfig config;
+    /// The devices are made up: don't remember their sensor IDs in a file.
+    config.sensorIdMapFile.clear();
+    DriverHostPtr host(new ViveDriverHost);
+    host->startWithoutDriver(config);
+    host->registerDevice(stub_pluginkit::getContext());
+    for (std::uint32_t dev = 0; dev < numDevices; ++dev) {
+        host->activateReplayedDevice(
+            dev, HMD_SENSOR == dev ? DeviceRole::HMD : DeviceRole::Controller,
+            "CACHE-" + std::to_string(dev));
+    }
+    stub_pluginkit::runUpdate();
+    stub_pluginkit::setKeepLatencies(false);
+    Logger::instance().flush();
+    stub_pluginkit::resetStats();
+
+    pinCurrentThread(0);
+    std::atomic<bool> stop{false};
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::duration<double>(opts.seconds));
+    counters.start();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> producers;
+    for (std::size_t t = 0; t < opts.producerThreads; ++t) {
+        producers.emplace_back([&, t] {
+            pinCurrentThread(t + 1);
+            auto first = static_cast<std::uint32_t>(t * 2);
+            for (std::size_t seq = 0; !stop; ++seq) {
+                for (auto dev = first; dev < first + 2; ++dev) {
+                    host->TrackedDevicePoseUpdated(dev, makePose(seq));
+                    if (HMD_SENSOR != dev && seq % POSES_PER_AXIS == 0) {
+                        vr::VRControllerAxis_t state;
+                        state.x = static_cast<float>(seq % 1000) * 0.001f;
+                        state.y = -state.x;
+                        host->TrackedDeviceAxisUpdated(dev, 0, state);
+                    }
+                }
+            }
+        });
+    }
+    while (std::chrono::steady_clock::now() < deadline) {
+        stub_pluginkit::runUpdate();
+    }
+    stop = true;
+    for (auto &thread : producers) {
+        thread.join();
+    }
+    stub_pluginkit::runUpdate();
+    counters.stop();
+    auto seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+    using stub_pluginkit::SendType;
+    auto sent = stub_pluginkit::getStats(SendType::Pose).count +
+                stub_pluginkit::getStats(SendType::Analog).count;
+    std::cout << PREFIX << "Report path, " << opts.producerThreads
+              << " driver threads: " << sent << " reports sent in "
+              << std::setprecision(3) << seconds << " s ("
+              << static_cast<std::uint64_t>(sent / seconds) << "/s)"
+              << std::endl;
+    if (counters.available() && sent > 0) {
+        counters.print(sent, "report");
+    }
+}
+
+/// Two threads each writing a counter of their own.
+template <typename Pair>
+static void benchmarkPair(const char *name, Options const &opts,
+                          Counters &counters) {
+    Pair pair;
+    std::atomic<bool> stop{false};
+    std::uint64_t writes = 0;
+    counters.start();
+    auto start = std::chrono::steady_clock::now();
+    std::thread other([&] {
+        pinCurrentThread(1);
+        std::uint64_t i = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            pair.consumer.store(++i, std::memory_order_relaxed);
+        }
+    });
+    pinCurrentThread(0);
+    auto deadline = start + std::chrono::duration_cast<
+                                std::chrono::steady_clock::duration>(
+                                std::chrono::duration<double>(opts.seconds));
+    while (std::chrono::steady_clock::now() < deadline) {
+        for (int i = 0; i < 1000; ++i) {
+            pair.producer.store(++writes, std::memory_order_relaxed);
+        }
+    }
+    stop = true;
+    other.join();
+    counters.stop();
+    auto seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    std::cout << PREFIX << name << ": " << writes << " writes in "
+              << std::setprecision(3) << seconds << " s" << std::endl;
+    if (counters.available()) {
+        counters.print(writes, "write");
+    }
+}
+
+struct SharedLine {
+    std::atomic<std::uint64_t> producer{0};
+    std::atomic<std::uint64_t> consumer{0};
+};
+
+struct SeparateLines {
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> producer{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> consumer{0};
+};
+
+int main(int argc, char *argv[]) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        usage(argv[0]);
+        return 1;
+    }
+    g_numCpus = std::max(1u, std::thread::hardware_concurrency());
+    if (g_numCpus < 2) {
+        std::cout << PREFIX << "Warning: only one CPU, so there's no other "
+                               "core for cache lines to bounce to."
+                  << std::endl;
+    }
+    Counters counters(opts.rawEvent);
+    if (!counters.available()) {
+        std::cout << PREFIX << "Performance counters unavailable ("
+                  << counters.getError() << "): timing only." << std::endl;
+    }
+
+    benchmarkPair<SharedLine>("Two counters, one cache line", opts, counters);
+    benchmarkPair<SeparateLines>("Two counters, separate lines", opts,
+                                 counters);
+    benchmarkReportPath(opts, counters);
+    return 0;
+}
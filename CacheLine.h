@@ -0,0 +1,92 @@
+/** @file
+    @brief Header for laying data out in cache lines, so state written by
+    one thread doesn't share a line with state another thread uses.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_CacheLine_h_GUID_9CB0AB44_ADCD_4FA2_AE01_89D04CBD4E83
+#define INCLUDED_CacheLine_h_GUID_9CB0AB44_ADCD_4FA2_AE01_89D04CBD4E83
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace osvr {
+namespace vive {
+
+    /// The cache line size of the x86 and ARM CPUs the plugin runs on.
+    /// Members written by different threads go at least this far apart.
+    static const std::size_t CACHE_LINE_SIZE = 64;
+
+    namespace detail {
+        inline void *cacheAlignedAlloc(std::size_t size) {
+#ifdef _WIN32
+            auto p = _aligned_malloc(size, CACHE_LINE_SIZE);
+#else
+            void *p = nullptr;
+            if (posix_memalign(&p, CACHE_LINE_SIZE, size) != 0) {
+                p = nullptr;
+            }
+#endif
+            if (!p) {
+                throw std::bad_alloc();
+            }
+            return p;
+        }
+
+        inline void cacheAlignedFree(void *p) {
+#ifdef _WIN32
+            _aligned_free(p);
+#else
+            std::free(p);
+#endif
+        }
+    } // namespace detail
+
+} // namespace vive
+} // namespace osvr
+
+/// For classes with members aligned to CACHE_LINE_SIZE: plain new only
+/// guarantees that alignment from C++17 on. Also satisfies fixed-size Eigen
+/// members, so use it in place of EIGEN_MAKE_ALIGNED_OPERATOR_NEW.
+#define OSVR_VIVE_CACHE_ALIGNED_OPERATOR_NEW                                   \
+    static void *operator new(std::size_t size) {                              \
+        return ::osvr::vive::detail::cacheAlignedAlloc(size);                  \
+    }                                                                          \
+    static void operator delete(void *p) {                                     \
+        ::osvr::vive::detail::cacheAlignedFree(p);                             \
+    }                                                                          \
+    static void *operator new(std::size_t, void *where) { return where; }      \
+    static void operator delete(void *, void *) {}
+
+#endif // INCLUDED_CacheLine_h_GUID_9CB0AB44_ADCD_4FA2_AE01_89D04CBD4E83
@@ -0,0 +1,227 @@
+/** @file
+    @brief Implementation
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "CallbackRecorder.h"
+#include "ThreadTuning.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <algorithm>
+#include <chrono>
+
+namespace osvr {
+namespace vive {
+    /// How long the writer sleeps when it finds the ring empty.
+    static const auto WRITER_IDLE_SLEEP = std::chrono::milliseconds(2);
+
+    /// How often the writer flushes the file while records keep coming.
+    static const auto WRITER_FLUSH_INTERVAL = std::chrono::milliseconds(500);
+
+    /// The timestamp for a record made now.
+    static std::uint64_t recordTimestamp() {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+    }
+
+    CallbackRecorder::CallbackRecorder(std::string const &fn,
+                                       std::size_t capacity)
+        : ring_(capacity) {
+        /// If the file already has a trace in it, only append if we'd be
+        /// writing the same format.
+        bool haveHeader = false;
+        {
+            std::ifstream existing(fn, std::ios::in | std::ios::binary);
+            trace::FileHeader header;
+            if (existing &&
+                existing.read(reinterpret_cast<char *>(&header),
+                              sizeof(header))) {
+                if (!trace::isCompatible(header)) {
+                    message_ = fn + " already exists and is not a compatible "
+                                    "callback trace";
+                    return;
+                }
+                haveHeader = true;
+            }
+        }
+        file_.open(fn, std::ios::out | std::ios::app | std::ios::binary);
+        if (!file_) {
+            message_ = "Could not open " + fn + " for writing";
+            return;
+        }
+        if (!haveHeader) {
+            auto header = trace::makeFileHeader();
+            file_.write(reinterpret_cast<const char *>(&header),
+                        sizeof(header));
+        }
+        /// Timestamps from an earlier session appended to may have counted
+        /// from a different epoch, so replay needs to know where ours begin.
+        trace::Record session;
+        session.header.timestamp = recordTimestamp();
+        session.header.device = 0;
+        session.header.type = trace::RecordType::SessionStart;
+        session.header.reserved = 0;
+        session.header.payloadSize = 0;
+        trace::writeRecord(file_, session);
+        open_ = true;
+        thread_ = std::thread([this] { writerThread(); });
+    }
+
+    CallbackRecorder::~CallbackRecorder() {
+        stopping_ = true;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void CallbackRecorder::submit(trace::Record &rec, std::uint32_t device,
+                                  trace::RecordType type) {
+        if (!open_) {
+            return;
+        }
+        rec.header.timestamp = recordTimestamp();
+        rec.header.device = device;
+        rec.header.type = type;
+        rec.header.reserved = 0;
+        if (!ring_.tryPush(rec)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void CallbackRecorder::recordPose(std::uint32_t device,
+                                      vr::DriverPose_t const &pose) {
+        trace::Record rec;
+        rec.setPayload(pose);
+        submit(rec, device, trace::RecordType::Pose);
+    }
+
+    void CallbackRecorder::recordButton(trace::RecordType type,
+                                        std::uint32_t device,
+                                        vr::EVRButtonId button,
+                                        double eventTimeOffset) {
+        trace::Record rec;
+        trace::ButtonPayload p;
+        p.button = static_cast<std::uint32_t>(button);
+        p.reserved = 0;
+        p.eventTimeOffset = eventTimeOffset;
+        rec.setPayload(p);
+        submit(rec, device, type);
+    }
+
+    void CallbackRecorder::recordAxis(std::uint32_t device, std::uint32_t axis,
+                                      vr::VRControllerAxis_t const &state) {
+        trace::Record rec;
+        trace::AxisPayload p;
+        p.axis = axis;
+        p.x = state.x;
+        p.y = state.y;
+        rec.setPayload(p);
+        submit(rec, device, trace::RecordType::Axis);
+    }
+
+    void CallbackRecorder::recordIpd(std::uint32_t device, float meters) {
+        trace::Record rec;
+        trace::IpdPayload p;
+        p.meters = meters;
+        rec.setPayload(p);
+        submit(rec, device, trace::RecordType::Ipd);
+    }
+
+    void CallbackRecorder::recordProximity(std::uint32_t device,
+                                           bool triggered) {
+        trace::Record rec;
+        trace::ProximityPayload p;
+        p.triggered = triggered ? 1 : 0;
+        rec.setPayload(p);
+        submit(rec, device, trace::RecordType::Proximity);
+    }
+
+    void CallbackRecorder::recordPropertiesChanged(std::uint32_t device) {
+        trace::Record rec;
+        rec.header.payloadSize = 0;
+        submit(rec, device, trace::RecordType::PropertiesChanged);
+    }
+
+    void CallbackRecorder::recordDeviceAdded(std::uint32_t device,
+                                             std::uint8_t role,
+                                             std::string const &serial) {
+        trace::Record rec;
+        trace::DeviceAddedPayload p;
+        p.role = role;
+        auto len = std::min(serial.size(), trace::MAX_SERIAL_LENGTH);
+        std::copy_n(serial.begin(), len, p.serial);
+        rec.setPayload(p);
+        /// Trim the unused part of the serial number buffer.
+        rec.header.payloadSize = static_cast<std::uint16_t>(
+            sizeof(trace::DeviceAddedPayload) - trace::MAX_SERIAL_LENGTH +
+            len);
+        submit(rec, device, trace::RecordType::DeviceAdded);
+    }
+
+    void CallbackRecorder::recordVendorEvent(std::uint32_t device,
+                                             vr::EVREventType type,
+                                             double eventTimeOffset) {
+        trace::Record rec;
+        trace::VendorEventPayload p;
+        p.eventType = static_cast<std::uint32_t>(type);
+        p.reserved = 0;
+        p.eventTimeOffset = eventTimeOffset;
+        rec.setPayload(p);
+        submit(rec, device, trace::RecordType::VendorEvent);
+    }
+
+    void CallbackRecorder::writerThread() {
+        OwnedThread thread("vive-trace");
+        trace::Record rec;
+        auto lastFlush = std::chrono::steady_clock::now();
+        for (;;) {
+            /// Check before draining, so everything pushed before we were
+            /// asked to stop gets written.
+            bool stopping = stopping_;
+            bool wroteAny = false;
+            while (ring_.tryPop(rec)) {
+                trace::writeRecord(file_, rec);
+                wroteAny = true;
+            }
+            if (stopping) {
+                break;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastFlush > WRITER_FLUSH_INTERVAL) {
+                file_.flush();
+                lastFlush = now;
+            }
+            if (!wroteAny) {
+                std::this_thread::sleep_for(WRITER_IDLE_SLEEP);
+            }
+        }
+        file_.flush();
+    }
+
+} // namespace vive
+} // namespace osvr
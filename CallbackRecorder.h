@@ -0,0 +1,106 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_CallbackRecorder_h_GUID_E48B1D6A_7C25_4F39_B0E2_96A3C5D8F174
+#define INCLUDED_CallbackRecorder_h_GUID_E48B1D6A_7C25_4F39_B0E2_96A3C5D8F174
+
+// Internal Includes
+#include "MpscRing.h"
+#include "TraceFormat.h"
+
+// Library/third-party includes
+#include <openvr_driver.h>
+
+// Standard includes
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace osvr {
+namespace vive {
+
+    /// Records driver callbacks to a binary trace file (see TraceFormat.h).
+    ///
+    /// The record methods are callable from any thread and never block: they
+    /// push onto a lock-free ring that a background thread drains to disk. If
+    /// the writer falls far enough behind that the ring fills, records are
+    /// dropped (and counted) rather than stalling the driver.
+    class CallbackRecorder {
+      public:
+        /// Opens the file for appending, marks the start of a new session in
+        /// it, and starts the writer thread. Check isOpen() afterwards.
+        explicit CallbackRecorder(std::string const &fn,
+                                  std::size_t capacity = 8192);
+        /// Writes out anything still queued and closes the file.
+        ~CallbackRecorder();
+
+        CallbackRecorder(CallbackRecorder const &) = delete;
+        CallbackRecorder &operator=(CallbackRecorder const &) = delete;
+
+        bool isOpen() const { return open_; }
+
+        /// Why the file couldn't be opened, if it couldn't.
+        std::string const &getMessage() const { return message_; }
+
+        /// Records lost to a full ring so far.
+        std::uint64_t getDropped() const { return dropped_; }
+
+        /// @name Record methods - any thread
+        /// @{
+        void recordPose(std::uint32_t device, vr::DriverPose_t const &pose);
+        /// @param type One of the Button* record types.
+        void recordButton(trace::RecordType type, std::uint32_t device,
+                          vr::EVRButtonId button, double eventTimeOffset);
+        void recordAxis(std::uint32_t device, std::uint32_t axis,
+                        vr::VRControllerAxis_t const &state);
+        void recordIpd(std::uint32_t device, float meters);
+        void recordProximity(std::uint32_t device, bool triggered);
+        void recordPropertiesChanged(std::uint32_t device);
+        void recordDeviceAdded(std::uint32_t device, std::uint8_t role,
+                               std::string const &serial);
+        void recordVendorEvent(std::uint32_t device, vr::EVREventType type,
+                               double eventTimeOffset);
+        /// @}
+
+      private:
+        /// Fill in the header's timestamp and push.
+        void submit(trace::Record &rec, std::uint32_t device,
+                    trace::RecordType type);
+        void writerThread();
+
+        std::ofstream file_;
+        bool open_ = false;
+        std::string message_;
+        MpscRing<trace::Record> ring_;
+        std::atomic<std::uint64_t> dropped_{0};
+        std::atomic<bool> stopping_{false};
+        std::thread thread_;
+    };
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_CallbackRecorder_h_GUID_E48B1D6A_7C25_4F39_B0E2_96A3C5D8F174
@@ -59,6 +59,7 @@ namespace vive {
         /// move constructible
         DeviceHolder(DeviceHolder &&other)
             : devices_(std::move(other.devices_)),
+              numReserved_(other.numReserved_),
               deactivateOnShutdown_(other.deactivateOnShutdown_) {
             other.disableDeactivateOnShutdown();
         }
@@ -72,22 +73,29 @@ namespace vive {
                 deactivateAll();
             }
             devices_ = std::move(other.devices_);
+            numReserved_ = other.numReserved_;
             deactivateOnShutdown_ = other.deactivateOnShutdown_;
             other.disableDeactivateOnShutdown();
             return *this;
         }
 
+        /// Add and activate a device at the first free id past the reserved
+        /// ones, re-using ids freed by deactivate() before adding new ones.
         std::pair<bool, std::uint32_t>
         addAndActivateDevice(vr::ITrackedDeviceServerDriver *dev) {
             /// check to make sure it's not null and not already in there
             if (!dev || findDevice(dev).first) {
                 return std::make_pair(false, 0);
             }
-            auto it = std::find(begin(devices_), end(devices_), dev);
-            if (it != end(devices_)) {
+            auto it = std::find(begin(devices_) + numReserved_, end(devices_),
+                                nullptr);
+            auto newId =
+                static_cast<std::uint32_t>(std::distance(begin(devices_), it));
+            if (it == end(devices_)) {
+                devices_.push_back(dev);
+            } else {
+                *it = dev;
             }
-            auto newId = static_cast<std::uint32_t>(devices_.size());
-            devices_.push_back(dev);
             dev->Activate(newId);
             return std::make_pair(true, newId);
         }
@@ -130,12 +138,58 @@ namespace vive {
             return std::make_pair(true, idx);
         }
 
+        /// Put a device at a reserved id without activating it yet, so the id
+        /// can be claimed while holding a lock and the device activated once
+        /// it's released.
+        /// @return (true, idx) if it's now at idx, having already been there
+        /// or not.
+        std::pair<bool, std::uint32_t>
+        placeDeviceAt(vr::ITrackedDeviceServerDriver *dev, std::uint32_t idx) {
+            if (!dev) {
+                return std::make_pair(false, 0);
+            }
+            auto existing = findDevice(dev);
+            if (existing.first) {
+                return std::make_pair(existing.second == idx, existing.second);
+            }
+            if (!(idx < devices_.size())) {
+                reserveIds(idx + 1);
+            }
+            if (devices_[idx]) {
+                return std::make_pair(false, 0);
+            }
+            devices_[idx] = dev;
+            return std::make_pair(true, idx);
+        }
+
+        /// Put a device at the first free id past the reserved ones, like
+        /// addAndActivateDevice() but without activating it yet.
+        std::pair<bool, std::uint32_t>
+        placeDevice(vr::ITrackedDeviceServerDriver *dev) {
+            if (!dev || findDevice(dev).first) {
+                return std::make_pair(false, 0);
+            }
+            auto it = std::find(begin(devices_) + numReserved_, end(devices_),
+                                nullptr);
+            auto newId =
+                static_cast<std::uint32_t>(std::distance(begin(devices_), it));
+            if (it == end(devices_)) {
+                devices_.push_back(dev);
+            } else {
+                *it = dev;
+            }
+            return std::make_pair(true, newId);
+        }
+
         /// Reserve the first n ids, if not already allocated, for manual
         /// allocation. (More like a non-shrinking resize() than reserve() in
         /// c++ standard container terminology, so don't let that confuse you)
         /// @return true if this action resulted in any actual addition of null
         /// entries to the device list.
         bool reserveIds(std::uint32_t n) {
+            if (numReserved_ < n) {
+                numReserved_ = n;
+            }
             if (devices_.size() < n) {
                 devices_.resize(n, nullptr);
                 return true;
@@ -177,7 +231,8 @@ namespace vive {
                                  });
         }
 
-        /// @return false if there was no device there to deactivate.
+        /// @return false if there was no device there to deactivate. The id
+        /// is free for re-use afterwards.
         bool deactivate(std::uint32_t idx) {
             if (idx < devices_.size() && devices_[idx]) {
                 devices_[idx]->Deactivate();
@@ -212,8 +267,10 @@ namespace vive {
         }
 
       private:
-        bool deactivateOnShutdown_ = true;
         std::vector<vr::ITrackedDeviceServerDriver *> devices_;
+        /// Ids below this are only handed out by addAndActivateDeviceAt()
+        std::uint32_t numReserved_ = 0;
+        bool deactivateOnShutdown_ = true;
     };
 
 } // namespace vive
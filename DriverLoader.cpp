@@ -25,13 +25,15 @@
 // Internal Includes
 #include "DriverLoader.h"
 #include "InterfaceTraits.h"
+#include "Logger.h"
 #include "SearchPathExtender.h"
+#include "StartupTimeline.h"
 
 // Library/third-party includes
 #include <osvr/Util/PlatformConfig.h>
 
 // Standard includes
-#include <iostream>
+// - none
 
 #if defined(OSVR_WINDOWS)
 
@@ -82,6 +84,7 @@ namespace vive {
         /// Set the PATH to include the driver directory so it can
         /// find its deps.
         SearchPathExtender extender(driverRoot);
+        StartupPhase phase("dlopen");
 #if defined(OSVR_WINDOWS)
         impl_->driver_ = LoadLibraryA(driverFile.c_str());
         if (!impl_->driver_) {
@@ -128,6 +131,7 @@ namespace vive {
     }
 
     bool DriverLoader::isHMDPresent(std::string const &userConfigDir) const {
+        StartupPhase phase("isHMDPresent");
         auto ret = getInterface<vr::IClientTrackedDeviceProvider>();
         if (ret.first) {
             // std::cout << "Successfully got the
@@ -147,17 +151,15 @@ namespace vive {
     void DriverLoader::reset() {
         if (cleanup_) {
 #if 0
-            std::cout << "osvr::vive::DriverLoader::reset() - cleaning "
-                         "up main provider"
-                      << std::endl;
+            logInfo() << "osvr::vive::DriverLoader::reset() - cleaning "
+                         "up main provider";
 #endif
             cleanup_();
             cleanup_ = std::function<void()>{};
         }
         if (impl_) {
 #if 0
-            std::cout << "osvr::vive::DriverLoader::reset() - unloading driver"
-                      << std::endl;
+            logInfo() << "osvr::vive::DriverLoader::reset() - unloading driver";
 #endif
             impl_.reset();
         }
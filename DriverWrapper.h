@@ -32,6 +32,8 @@
 #include "FindDriver.h"
 #include "GetProvider.h"
 #include "ServerDriverHost.h"
+#include "StartupTimeline.h"
+#include "VRSettings.h"
 
 // Library/third-party includes
 // - none
@@ -84,6 +86,7 @@ namespace vive {
               serverDriverHost_(std::move(other.serverDriverHost_)),
               locations_(std::move(other.locations_)),
               chaperone_(std::move(other.chaperone_)),
+              settings_(std::move(other.settings_)),
               loader_(std::move(other.loader_)),
               serverDeviceProvider_(std::move(other.serverDeviceProvider_)),
               devices_(std::move(other.devices_)) {}
@@ -221,7 +224,17 @@ namespace vive {
             if (!foundConfigDirs()) {
                 return;
             }
-            chaperone_.reset(new ChaperoneData(getRootConfigDir()));
+            {
+                StartupPhase phase("ChaperoneData");
+                chaperone_.reset(new ChaperoneData(getRootConfigDir()));
+            }
+            {
+                StartupPhase phase("VRSettings");
+                settings_.reset(new VRSettings);
+                settings_->load(
+                    VRSettings::getSettingsFile(getRootConfigDir()));
+                serverDriverHost_->vrSettings = settings_.get();
+            }
 
             loader_ = DriverLoader::make(locations_.driverRoot,
                                          locations_.driverFile);
@@ -238,6 +251,8 @@ namespace vive {
 
         LocationInfo locations_;
         std::unique_ptr<ChaperoneData> chaperone_;
+        /// Declared before the driver, so it outlives it.
+        std::unique_ptr<VRSettings> settings_;
 
         std::unique_ptr<DriverLoader> loader_;
         ProviderPtr<vr::IServerTrackedDeviceProvider> serverDeviceProvider_;
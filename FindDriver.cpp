@@ -24,6 +24,8 @@
 
 // Internal Includes
 #include "FindDriver.h"
+#include "Logger.h"
+#include "StartupTimeline.h"
 
 // Library/third-party includes
 #include <boost/iostreams/stream.hpp>
@@ -33,9 +35,13 @@
 #include <osvr/Util/PlatformConfig.h>
 
 // Standard includes
+#include <cstdlib> // for getenv
+#include <exception>
 #include <fstream> // std::ifstream
-#include <iostream>
 #include <limits.h>
+#include <map>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #if defined(OSVR_USING_FILESYSTEM_HEADER)
@@ -46,8 +52,6 @@
 
 #if defined(OSVR_WINDOWS)
 #include <shlobj.h>
-#else
-#include <cstdlib> // for getenv
 #endif
 
 #undef VIVELOADER_VERBOSE
@@ -80,6 +84,7 @@ namespace vive {
     using std::tr2::sys::path;
     using std::tr2::sys::wpath;
     using std::tr2::sys::exists;
+    using std::tr2::sys::last_write_time;
 #elif defined(OSVR_USING_FILESYSTEM_EXPERIMENTAL)
     using std::experimental::filesystem::path;
 #ifdef _WIN32
@@ -88,9 +93,11 @@ namespace vive {
     using wpath = path;
 #endif
     using std::experimental::filesystem::exists;
+    using std::experimental::filesystem::last_write_time;
 #elif defined(OSVR_USING_BOOST_FILESYSTEM)
     using boost::filesystem::path;
     using boost::filesystem::exists;
+    using boost::filesystem::last_write_time;
 #endif
 
 #ifdef OSVR_MACOSX
@@ -111,63 +118,99 @@ namespace vive {
     inline void parsePathConfigFile(std::istream &is, Json::Value &ret) {
         Json::Reader reader;
         if (!reader.parse(is, ret)) {
-            std::cerr << "Error parsing file containing path configuration - "
-                         "have you run SteamVR yet?"
-                      << std::endl;
-            std::cerr << reader.getFormattedErrorMessages() << std::endl;
+            logError() << "Error parsing file containing path configuration "
+                          "- have you run SteamVR yet? "
+                       << reader.getFormattedErrorMessages();
         }
     }
 
 #if defined(OSVR_WINDOWS)
-    inline Json::Value getPathConfig() {
+    using config_path = wpath;
+
+    inline bool getPathConfigFilename(config_path &vrPaths) {
         PWSTR outString = nullptr;
-        Json::Value ret;
         // It's OK to use Vista+ stuff here, since openvr_api.dll uses Vista+
         // stuff too.
         auto hr =
             SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &outString);
+        // Free the string returned when we're all done - even on failure.
+        auto freeString = finally([&] { CoTaskMemFree(outString); });
         if (!SUCCEEDED(hr)) {
-            std::cerr << "Could not get local app data directory!" << std::endl;
-            return ret;
+            logError() << "Could not get local app data directory!";
+            return false;
         }
-        // Free the string returned when we're all done.
-        auto freeString = [&] { CoTaskMemFree(outString); };
         // Build the path to the file.
-        auto vrPaths =
+        vrPaths =
             wpath(outString) / wpath(L"openvr") / wpath(L"openvrpaths.vrpath");
-        std::ifstream is(vrPaths.string());
-        if (!is) {
-            std::wcerr << L"Could not open file containing path configuration "
-                          L"- have you run SteamVR yet? "
-                       << vrPaths << L"\n";
-            return ret;
-        }
-        parsePathConfigFile(is, ret);
-        return ret;
+        return true;
+    }
+
+    inline void reportMissingPathConfig(config_path const &vrPaths) {
+        logError() << "Could not open file containing path configuration "
+                      "- have you run SteamVR yet? "
+                   << vrPaths.string();
     }
 
 #elif defined(OSVR_MACOSX) || defined(OSVR_LINUX)
-    inline Json::Value getPathConfig() {
+    using config_path = path;
+
+    inline bool getPathConfigFilename(config_path &vrPaths) {
         auto home = std::getenv("HOME");
         path homePath =
             (nullptr == home
                  ? path{"~"}
                  /*that's weird, should have been in environment...*/
                  : path{home});
-        auto vrPaths = homePath / path{".openvr"} / path{"openvrpaths.vrpath"};
+        vrPaths = homePath / path{".openvr"} / path{"openvrpaths.vrpath"};
+        return true;
+    }
 
+    inline void reportMissingPathConfig(config_path const &vrPaths) {
+        logError() << "Could not open file containing path configuration "
+                      "- have you run SteamVR yet? "
+                   << vrPaths;
+    }
+#endif
+
+    inline Json::Value loadPathConfig(config_path const &vrPaths) {
         std::ifstream is(vrPaths.string());
         Json::Value ret;
         if (!is) {
-            std::cerr << "Could not open file containing path configuration "
-                         "- have you run SteamVR yet? "
-                      << vrPaths << "\n";
+            reportMissingPathConfig(vrPaths);
             return ret;
         }
         parsePathConfigFile(is, ret);
         return ret;
     }
-#endif
+
+    /// Modification time of a file or directory, if it exists. Used to tell
+    /// when cached discovery results have gone stale.
+    using file_time = decltype(last_write_time(std::declval<path>()));
+    struct FileStamp {
+        bool exists = false;
+        file_time time = file_time{};
+        bool operator==(FileStamp const &other) const {
+            return exists == other.exists && (!exists || time == other.time);
+        }
+        bool operator!=(FileStamp const &other) const {
+            return !(*this == other);
+        }
+    };
+
+    template <typename PathType>
+    inline FileStamp getFileStamp(PathType const &p) {
+        FileStamp ret;
+        try {
+            if (exists(p)) {
+                ret.time = last_write_time(p);
+                ret.exists = true;
+            }
+        } catch (std::exception &) {
+            // Treat as missing: it'll look different once it's readable.
+            ret = FileStamp{};
+        }
+        return ret;
+    }
 
     inline std::vector<std::string> getSteamVRRoots(Json::Value const &json) {
         std::vector<std::string> ret;
@@ -181,10 +224,6 @@ namespace vive {
         return ret;
     }
 
-    inline std::vector<std::string> getSteamVRRoots() {
-        return getSteamVRRoots(getPathConfig());
-    }
-
     inline void computeDriverRootAndFilePath(DriverLocationInfo &info,
                                              std::string const &driver) {
         auto p = path{info.steamVrRoot};
@@ -214,13 +253,12 @@ namespace vive {
             computeDriverRootAndFilePath(info, driver);
 
 #ifdef VIVELOADER_VERBOSE
-            std::cout << "Will try to load driver from:\n"
-                      << info.driverFile << std::endl;
+            logInfo() << "Will try to load driver from: " << info.driverFile;
             if (exists(path{info.driverRoot})) {
-                std::cout << "Driver root exists" << std::endl;
+                logInfo() << "Driver root exists";
             }
             if (exists(path{info.driverFile})) {
-                std::cout << "Driver file exists" << std::endl;
+                logInfo() << "Driver file exists";
             }
 #endif
 
@@ -234,31 +272,6 @@ namespace vive {
         return info;
     }
 
-    DriverLocationInfo findDriver(std::string const &driver) {
-        return findDriver(getPathConfig(), driver);
-    }
-
-    std::string getToolLocation(std::string const &toolName,
-                                std::string const &steamVrRoot) {
-        std::vector<std::string> searchPath;
-        if (!steamVrRoot.empty()) {
-            searchPath = {steamVrRoot};
-        } else {
-            searchPath = getSteamVRRoots();
-        }
-
-        for (auto &root : searchPath) {
-            auto p = path{root};
-            p /= "bin";
-            p /= getPlatformDirname();
-            p /= (toolName + TOOL_EXTENSION);
-            if (exists(p)) {
-                return p.string();
-            }
-        }
-        return std::string{};
-    }
-
     /// Underlying implementation - hand it the preloaded json.
     inline ConfigDirs findConfigDirs(Json::Value const &json,
                                      std::string const &driver) {
@@ -281,13 +294,9 @@ namespace vive {
         return ret;
     }
 
-    ConfigDirs findConfigDirs(std::string const & /*steamVrRoot*/,
-                              std::string const &driver) {
-        return findConfigDirs(getPathConfig(), driver);
-    }
-
-    LocationInfo findLocationInfoForDriver(std::string const &driver) {
-        auto json = getPathConfig();
+    /// Underlying implementation - hand it the preloaded json.
+    inline LocationInfo findLocationInfoForDriver(Json::Value const &json,
+                                                  std::string const &driver) {
         LocationInfo ret;
 
         auto config = findConfigDirs(json, driver);
@@ -308,5 +317,205 @@ namespace vive {
         return ret;
     }
 
+    /// Process-wide cache of the path config file and everything we work out
+    /// from it, so repeated hardware detection doesn't keep re-reading and
+    /// re-parsing it and stat-ing the same directories.
+    ///
+    /// Results are thrown out when the modification time of the path config
+    /// file, or of any runtime or config directory it names, changes.
+    class DiscoveryCache {
+      public:
+        static DiscoveryCache &get() {
+            static DiscoveryCache cache;
+            return cache;
+        }
+
+        DriverLocationInfo findDriver(std::string const &driver) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            revalidate();
+            return lookup(drivers_, driver, [&] {
+                return vive::findDriver(json_, driver);
+            });
+        }
+
+        ConfigDirs findConfigDirs(std::string const &driver) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            revalidate();
+            return lookup(configDirs_, driver, [&] {
+                return vive::findConfigDirs(json_, driver);
+            });
+        }
+
+        LocationInfo findLocationInfoForDriver(std::string const &driver) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            revalidate();
+            return lookup(locations_, driver, [&] {
+                return vive::findLocationInfoForDriver(json_, driver);
+            });
+        }
+
+        std::vector<std::string> getSteamVRRoots() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            revalidate();
+            return roots_;
+        }
+
+      private:
+        DiscoveryCache() = default;
+
+        template <typename T, typename F>
+        static T lookup(std::map<std::string, T> &results,
+                        std::string const &driver, F &&compute) {
+            auto it = results.find(driver);
+            if (it == results.end()) {
+                it = results.emplace(driver, compute()).first;
+            }
+            return it->second;
+        }
+
+        /// Must hold the mutex. Re-reads the file and drops derived results
+        /// if anything they depend on changed since last time.
+        void revalidate() {
+            config_path vrPaths;
+            auto haveFilename = getPathConfigFilename(vrPaths);
+            auto fileStamp = haveFilename ? getFileStamp(vrPaths) : FileStamp{};
+            if (valid_ && fileStamp == fileStamp_ && dirsUnchanged()) {
+                return;
+            }
+            if (!valid_ || fileStamp != fileStamp_) {
+                json_ = haveFilename ? loadPathConfig(vrPaths) : Json::Value{};
+                fileStamp_ = fileStamp;
+                roots_ = vive::getSteamVRRoots(json_);
+            }
+            stampDirs();
+            drivers_.clear();
+            configDirs_.clear();
+            locations_.clear();
+            valid_ = true;
+        }
+
+        /// The runtime roots (and their driver directories, where a new
+        /// driver would show up) and the config directories.
+        void stampDirs() {
+            dirStamps_.clear();
+            auto stamp = [&](path const &p) {
+                dirStamps_.emplace_back(p.string(), getFileStamp(p));
+            };
+            for (auto const &root : roots_) {
+                stamp(path{root});
+                stamp(path{root} / path{"drivers"});
+            }
+            auto const &configLocations = json_["config"];
+            if (configLocations.isArray()) {
+                for (auto &configDir : configLocations) {
+                    stamp(path{configDir.asString()});
+                }
+            }
+        }
+
+        bool dirsUnchanged() const {
+            for (auto const &entry : dirStamps_) {
+                if (getFileStamp(path{entry.first}) != entry.second) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        std::mutex mutex_;
+        bool valid_ = false;
+        FileStamp fileStamp_;
+        std::vector<std::pair<std::string, FileStamp>> dirStamps_;
+        Json::Value json_;
+        std::vector<std::string> roots_;
+        std::map<std::string, DriverLocationInfo> drivers_;
+        std::map<std::string, ConfigDirs> configDirs_;
+        std::map<std::string, LocationInfo> locations_;
+    };
+
+    /// Location info built from DRIVER_OVERRIDE_ENV and
+    /// CONFIG_DIR_OVERRIDE_ENV, bypassing SteamVR's path config entirely.
+    /// @return false if no override is set.
+    inline bool getOverrideLocationInfo(std::string const &driver,
+                                        LocationInfo &ret) {
+        auto driverFile = std::getenv(DRIVER_OVERRIDE_ENV);
+        if (nullptr == driverFile || '\0' == driverFile[0]) {
+            return false;
+        }
+        ret = LocationInfo{};
+        auto driverPath = path{driverFile};
+        ret.driverFile = driverPath.string();
+        ret.driverRoot = driverPath.parent_path().string();
+        ret.driverName = driver;
+        ret.driverFound = exists(driverPath);
+
+        auto configDir = std::getenv(CONFIG_DIR_OVERRIDE_ENV);
+        auto configPath = (nullptr == configDir || '\0' == configDir[0])
+                              ? driverPath.parent_path()
+                              : path{configDir};
+        ret.rootConfigDir = configPath.string();
+        ret.driverConfigDir = (configPath / path{driver}).string();
+        ret.configFound = exists(configPath);
+
+        ret.found = ret.driverFound && ret.configFound;
+        return true;
+    }
+
+    DriverLocationInfo findDriver(std::string const &driver) {
+        LocationInfo overridden;
+        if (getOverrideLocationInfo(driver, overridden)) {
+            DriverLocationInfo ret;
+            ret.driverRoot = overridden.driverRoot;
+            ret.driverFile = overridden.driverFile;
+            ret.driverName = overridden.driverName;
+            ret.found = overridden.driverFound;
+            return ret;
+        }
+        return DiscoveryCache::get().findDriver(driver);
+    }
+
+    std::string getToolLocation(std::string const &toolName,
+                                std::string const &steamVrRoot) {
+        std::vector<std::string> searchPath;
+        if (!steamVrRoot.empty()) {
+            searchPath = {steamVrRoot};
+        } else {
+            searchPath = DiscoveryCache::get().getSteamVRRoots();
+        }
+
+        for (auto &root : searchPath) {
+            auto p = path{root};
+            p /= "bin";
+            p /= getPlatformDirname();
+            p /= (toolName + TOOL_EXTENSION);
+            if (exists(p)) {
+                return p.string();
+            }
+        }
+        return std::string{};
+    }
+
+    ConfigDirs findConfigDirs(std::string const & /*steamVrRoot*/,
+                              std::string const &driver) {
+        LocationInfo overridden;
+        if (getOverrideLocationInfo(driver, overridden)) {
+            ConfigDirs ret;
+            ret.rootConfigDir = overridden.rootConfigDir;
+            ret.driverConfigDir = overridden.driverConfigDir;
+            ret.valid = overridden.configFound;
+            return ret;
+        }
+        return DiscoveryCache::get().findConfigDirs(driver);
+    }
+
+    LocationInfo findLocationInfoForDriver(std::string const &driver) {
+        StartupPhase phase("findLocationInfoForDriver");
+        LocationInfo ret;
+        if (getOverrideLocationInfo(driver, ret)) {
+            return ret;
+        }
+        return DiscoveryCache::get().findLocationInfoForDriver(driver);
+    }
+
 } // namespace vive
 } // namespace osvr
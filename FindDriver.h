@@ -39,6 +39,15 @@ namespace vive {
 
     static const auto DRIVER_NAME = "lighthouse";
 
+    /// Environment variable that, if set to the full path of a driver
+    /// library, is used in place of the SteamVR-installed driver - to load a
+    /// mock driver, for instance.
+    static const auto DRIVER_OVERRIDE_ENV = "OSVR_VIVE_DRIVER";
+
+    /// Environment variable giving the root config dir to use along with
+    /// DRIVER_OVERRIDE_ENV. Defaults to the overriding driver's directory.
+    static const auto CONFIG_DIR_OVERRIDE_ENV = "OSVR_VIVE_CONFIG_DIR";
+
     struct DriverLocationInfo {
         std::string steamVrRoot;
         std::string driverRoot;
@@ -28,12 +28,13 @@
 // Internal Includes
 #include "DriverLoader.h"
 #include "InterfaceTraits.h"
+#include "Logger.h"
+#include "StartupTimeline.h"
 
 // Library/third-party includes
 #include <openvr_driver.h>
 
 // Standard includes
-#include <iostream>
 #include <memory>
 #include <string>
 
@@ -60,12 +61,16 @@ namespace vive {
             /// gets unloaded.
             std::unique_ptr<DriverLoader> myLoader(std::move(loader));
             auto rawPtr = myLoader->getInterfaceThrowing<InterfaceType>();
-            auto initResults =
-                rawPtr->Init(driverLog, host, userDriverConfigDir.c_str(),
-                             myLoader->getDriverRoot().c_str());
+            vr::EVRInitError initResults;
+            {
+                StartupPhase phase("Init");
+                initResults =
+                    rawPtr->Init(driverLog, host, userDriverConfigDir.c_str(),
+                                 myLoader->getDriverRoot().c_str());
+            }
             if (vr::VRInitError_None != initResults) {
                 /// Failed, reset the loader pointer to unload the driver.
-                std::cout << "Got error code " << initResults << std::endl;
+                logError() << "Got error code " << initResults;
                 myLoader.reset();
                 return return_type{};
             }
@@ -0,0 +1,221 @@
+/** @file
+    @brief Implementation
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "InputMap.h"
+#include "Logger.h"
+
+// Library/third-party includes
+#include <json/value.h>
+
+// Standard includes
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace osvr {
+namespace vive {
+
+    const std::int8_t RoleInputMap::UNMAPPED;
+
+    RoleInputMap::RoleInputMap() {
+        press.fill(UNMAPPED);
+        touch.fill(UNMAPPED);
+        axisX.fill(UNMAPPED);
+        axisY.fill(UNMAPPED);
+    }
+
+    namespace {
+        struct NamedId {
+            const char *name;
+            std::uint32_t id;
+        };
+        const NamedId BUTTON_NAMES[] = {
+            {"system", vr::k_EButton_System},
+            {"menu", vr::k_EButton_ApplicationMenu},
+            {"grip", vr::k_EButton_Grip},
+            {"dpad_left", vr::k_EButton_DPad_Left},
+            {"dpad_up", vr::k_EButton_DPad_Up},
+            {"dpad_right", vr::k_EButton_DPad_Right},
+            {"dpad_down", vr::k_EButton_DPad_Down},
+            {"a", vr::k_EButton_A},
+            {"trackpad", vr::k_EButton_SteamVR_Touchpad},
+            {"trigger", vr::k_EButton_SteamVR_Trigger}};
+        const NamedId AXIS_NAMES[] = {{"trackpad", 0}, {"trigger", 1}};
+
+        const char *const ROLE_NAMES[] = {"hmd", "controller", "other"};
+
+        /// Parse a name from the table, or a number below limit.
+        template <std::size_t N>
+        bool parseId(std::string const &key, const NamedId (&names)[N],
+                     std::uint32_t limit, std::uint32_t &id) {
+            for (auto const &entry : names) {
+                if (key == entry.name) {
+                    id = entry.id;
+                    return true;
+                }
+            }
+            char *end = nullptr;
+            auto val = std::strtoul(key.c_str(), &end, 10);
+            if (key.empty() || *end != '\0' || val >= limit) {
+                return false;
+            }
+            id = static_cast<std::uint32_t>(val);
+            return true;
+        }
+
+        /// Check that a JSON value is an offset that fits in a channel block.
+        bool parseOffset(Json::Value const &val, OSVR_ChannelCount blockSize,
+                         std::int8_t &offset) {
+            if (!val.isIntegral() || val.asInt() < 0 ||
+                val.asInt() >= static_cast<int>(blockSize)) {
+                return false;
+            }
+            offset = static_cast<std::int8_t>(val.asInt());
+            return true;
+        }
+
+        void warnEntry(const char *role, const char *section,
+                       std::string const &key, const char *problem) {
+            logWarn() << "Ignoring input map entry " << role << "." << section
+                      << "." << key << ": " << problem;
+        }
+
+        /// @return true if there's a section object to load.
+        bool checkSection(Json::Value const &section, const char *role,
+                          const char *sectionName) {
+            if (section.isNull()) {
+                return false;
+            }
+            if (!section.isObject()) {
+                logWarn() << "Ignoring input map entry " << role << "."
+                          << sectionName << ": not a JSON object.";
+                return false;
+            }
+            return true;
+        }
+
+        void loadButtons(Json::Value const &section, const char *role,
+                         const char *sectionName, OSVR_ChannelCount blockSize,
+                         std::array<std::int8_t, vr::k_EButton_Max> &out) {
+            if (!checkSection(section, role, sectionName)) {
+                return;
+            }
+            for (auto const &key : section.getMemberNames()) {
+                std::uint32_t id;
+                if (!parseId(key, BUTTON_NAMES, vr::k_EButton_Max, id)) {
+                    warnEntry(role, sectionName, key, "unknown button");
+                    continue;
+                }
+                if (!parseOffset(section[key], blockSize, out[id])) {
+                    warnEntry(role, sectionName, key,
+                              "not a button offset within the block");
+                }
+            }
+        }
+
+        void loadAxes(Json::Value const &section, const char *role,
+                      OSVR_ChannelCount blockSize, RoleInputMap &out) {
+            if (!checkSection(section, role, "axes")) {
+                return;
+            }
+            for (auto const &key : section.getMemberNames()) {
+                std::uint32_t axis;
+                if (!parseId(key, AXIS_NAMES, vr::k_unControllerStateAxisCount,
+                             axis)) {
+                    warnEntry(role, "axes", key, "unknown axis");
+                    continue;
+                }
+                auto const &val = section[key];
+                std::int8_t x = RoleInputMap::UNMAPPED;
+                std::int8_t y = RoleInputMap::UNMAPPED;
+                if (!val.isArray() || val.size() < 1 || val.size() > 2 ||
+                    !parseOffset(val[0], blockSize, x) ||
+                    (val.size() == 2 && !parseOffset(val[1], blockSize, y))) {
+                    warnEntry(role, "axes", key,
+                              "not an array of one or two analog offsets "
+                              "within the block");
+                    continue;
+                }
+                out.axisX[axis] = x;
+                out.axisY[axis] = y;
+            }
+        }
+    } // namespace
+
+    InputMap::InputMap() {
+        auto &hmd = roles_[static_cast<std::size_t>(DeviceRole::HMD)];
+        hmd.press[vr::k_EButton_System] = HMD_SYSTEM_BUTTON_OFFSET;
+
+        auto &controller =
+            roles_[static_cast<std::size_t>(DeviceRole::Controller)];
+        controller.press[vr::k_EButton_System] = SYSTEM_BUTTON_OFFSET;
+        controller.press[vr::k_EButton_ApplicationMenu] = MENU_BUTTON_OFFSET;
+        controller.press[vr::k_EButton_Grip] = GRIP_BUTTON_OFFSET;
+        controller.press[vr::k_EButton_SteamVR_Touchpad] =
+            TRACKPAD_CLICK_BUTTON_OFFSET;
+        controller.press[vr::k_EButton_SteamVR_Trigger] = TRIGGER_BUTTON_OFFSET;
+        controller.touch[vr::k_EButton_SteamVR_Touchpad] =
+            TRACKPAD_TOUCH_BUTTON_OFFSET;
+        /// Axis 0 is the trackpad, axis 1 the trigger (which only uses x).
+        controller.axisX[0] = TRACKPAD_X_ANALOG_OFFSET;
+        controller.axisY[0] = TRACKPAD_Y_ANALOG_OFFSET;
+        controller.axisX[1] = TRIGGER_ANALOG_OFFSET;
+
+        /// Trackers and anything else get controller-sized channel blocks,
+        /// and the same mapping.
+        roles_[static_cast<std::size_t>(DeviceRole::Other)] = controller;
+    }
+
+    void InputMap::load(Json::Value const &root) {
+        if (!root.isObject()) {
+            logWarn() << "Ignoring input map: not a JSON object.";
+            return;
+        }
+        for (std::size_t i = 0; i < roles_.size(); ++i) {
+            auto const role = ROLE_NAMES[i];
+            auto const &entry = root[role];
+            if (entry.isNull()) {
+                continue;
+            }
+            if (!entry.isObject()) {
+                logWarn() << "Ignoring input map for " << role
+                          << ": not a JSON object.";
+                continue;
+            }
+            bool isHmd = static_cast<std::size_t>(DeviceRole::HMD) == i;
+            auto numButtons = isHmd ? HMD_NUM_BUTTONS : CONTROLLER_NUM_BUTTONS;
+            auto numAnalogs = isHmd ? HMD_NUM_ANALOGS : CONTROLLER_NUM_ANALOGS;
+            RoleInputMap map;
+            loadButtons(entry["buttons"], role, "buttons", numButtons,
+                        map.press);
+            loadButtons(entry["touches"], role, "touches", numButtons,
+                        map.touch);
+            loadAxes(entry["axes"], role, numAnalogs, map);
+            roles_[i] = map;
+        }
+    }
+
+} // namespace vive
+} // namespace osvr
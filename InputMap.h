@@ -0,0 +1,117 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_InputMap_h_GUID_C61F2A84_0B3E_4D57_9A1C_E84D7F2B35C0
+#define INCLUDED_InputMap_h_GUID_C61F2A84_0B3E_4D57_9A1C_E84D7F2B35C0
+
+// Internal Includes
+#include "SensorChannels.h"
+
+// Library/third-party includes
+#include <openvr_driver.h>
+
+// Standard includes
+#include <array>
+#include <cstdint>
+
+namespace Json {
+class Value;
+} // namespace Json
+
+namespace osvr {
+namespace vive {
+
+    /// Where one role's driver input events go, as offsets into the channel
+    /// blocks its sensors get - indexed directly by button ID or axis, so
+    /// routing an event is a single lookup.
+    struct RoleInputMap {
+        /// Marks a button or axis that isn't reported.
+        static const std::int8_t UNMAPPED = -1;
+
+        /// Button offset for presses of each driver button ID.
+        std::array<std::int8_t, vr::k_EButton_Max> press;
+        /// Button offset for touches of each driver button ID.
+        std::array<std::int8_t, vr::k_EButton_Max> touch;
+        /// Analog offsets for the x and y of each driver axis.
+        std::array<std::int8_t, vr::k_unControllerStateAxisCount> axisX;
+        std::array<std::int8_t, vr::k_unControllerStateAxisCount> axisY;
+
+        /// Everything unmapped.
+        RoleInputMap();
+
+        /// @name Lookups, tolerating out-of-range IDs from the driver
+        /// @{
+        std::int8_t getPress(std::uint32_t button) const {
+            return button < press.size() ? press[button] : UNMAPPED;
+        }
+        std::int8_t getTouch(std::uint32_t button) const {
+            return button < touch.size() ? touch[button] : UNMAPPED;
+        }
+        std::int8_t getAxisX(std::uint32_t axis) const {
+            return axis < axisX.size() ? axisX[axis] : UNMAPPED;
+        }
+        std::int8_t getAxisY(std::uint32_t axis) const {
+            return axis < axisY.size() ? axisY[axis] : UNMAPPED;
+        }
+        /// @}
+    };
+
+    /// Mapping of driver buttons and axes onto OSVR button and analog
+    /// channels, for each device role. Built once at startup, read-only
+    /// afterwards, so safe to read from the driver's threads.
+    class InputMap {
+      public:
+        /// The built-in mapping, matching com_osvr_Vive.json: on the HMD, the
+        /// system button; on controllers (and other devices), system, menu,
+        /// grip, trackpad touch and click, and trigger click, along with the
+        /// trackpad's x and y and the trigger's pull.
+        InputMap();
+
+        RoleInputMap const &get(DeviceRole role) const {
+            return roles_[static_cast<std::size_t>(role)];
+        }
+
+        /// Replace the mapping for each role given in a JSON object like:
+        ///
+        ///     "controller": {
+        ///         "buttons": {"system": 0, "menu": 1, "trigger": 5},
+        ///         "touches": {"trackpad": 3},
+        ///         "axes": {"trackpad": [0, 1], "trigger": [2]}
+        ///     }
+        ///
+        /// with "hmd", "controller" and "other" as the roles. Buttons may be
+        /// named or given by driver button ID, axes likewise; the values are
+        /// offsets within the role's block of channels. Roles left out keep
+        /// their mapping. Problems are reported to the log and the offending
+        /// entry skipped.
+        void load(Json::Value const &root);
+
+      private:
+        std::array<RoleInputMap, 3> roles_;
+    };
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_InputMap_h_GUID_C61F2A84_0B3E_4D57_9A1C_E84D7F2B35C0
@@ -0,0 +1,196 @@
+/** @file
+    @brief Implementation
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "Logger.h"
+#include "ThreadTuning.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cctype>
+#include <chrono>
+#include <iostream>
+
+namespace osvr {
+namespace vive {
+    static const auto PREFIX = "[OSVR-Vive] ";
+
+    /// Messages the ring can hold before new ones get dropped.
+    static const std::size_t LOG_QUEUE_CAPACITY = 1024;
+
+    /// How long the writer sleeps when it finds the ring empty.
+    static const auto WRITER_IDLE_SLEEP = std::chrono::milliseconds(5);
+
+    bool parseLogLevel(std::string const &name, LogLevel &level) {
+        static const struct {
+            const char *name;
+            LogLevel level;
+        } LEVELS[] = {{"trace", LogLevel::Trace},
+                      {"debug", LogLevel::Debug},
+                      {"info", LogLevel::Info},
+                      {"warn", LogLevel::Warn},
+                      {"error", LogLevel::Error}};
+        std::string lower;
+        for (auto c : name) {
+            lower.push_back(static_cast<char>(
+                std::tolower(static_cast<unsigned char>(c))));
+        }
+        for (auto const &entry : LEVELS) {
+            if (lower == entry.name) {
+                level = entry.level;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Logger &Logger::instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    Logger::Logger() : ring_(LOG_QUEUE_CAPACITY) {
+        thread_ = std::thread([this] { writerThread(); });
+    }
+
+    Logger::~Logger() {
+        stopping_ = true;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void Logger::submit(LogEntry const &entry) {
+        if (ring_.tryPush(entry)) {
+            submitted_.fetch_add(1, std::memory_order_release);
+        } else {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void Logger::flush() {
+        auto target = submitted_.load(std::memory_order_acquire);
+        while (written_.load(std::memory_order_acquire) < target) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void Logger::write(LogEntry const &entry) {
+        auto &os = entry.level >= LogLevel::Warn ? std::cerr : std::cout;
+        os << PREFIX;
+        os.write(entry.text, entry.length);
+        if (entry.truncated) {
+            os << "...";
+        }
+        os << "\n";
+    }
+
+    void Logger::writerThread() {
+        OwnedThread thread("vive-log");
+        LogEntry entry;
+        std::uint64_t reportedDropped = 0;
+        for (;;) {
+            /// Check before draining, so everything queued before we were
+            /// asked to stop gets written.
+            bool stopping = stopping_;
+            bool wroteAny = false;
+            while (ring_.tryPop(entry)) {
+                write(entry);
+                written_.fetch_add(1, std::memory_order_release);
+                wroteAny = true;
+            }
+            auto dropped = dropped_.load(std::memory_order_relaxed);
+            if (dropped != reportedDropped) {
+                std::cerr << PREFIX << "(" << dropped - reportedDropped
+                          << " log messages dropped)\n";
+                reportedDropped = dropped;
+                wroteAny = true;
+            }
+            if (wroteAny) {
+                /// Once per batch, instead of once per line.
+                std::cout.flush();
+            }
+            if (stopping) {
+                break;
+            }
+            if (!wroteAny) {
+                std::this_thread::sleep_for(WRITER_IDLE_SLEEP);
+            }
+        }
+    }
+
+    void LogStream::Buffer::attach(char *text) {
+        setp(text, text + LogEntry::MAX_LENGTH);
+    }
+
+    void LogStream::Buffer::takeState(Buffer const &other) {
+        pbump(static_cast<int>(other.size()));
+        truncated_ = other.truncated_;
+    }
+
+    LogStream::Buffer::int_type LogStream::Buffer::overflow(int_type ch) {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            truncated_ = true;
+        }
+        /// Claim success, so the stream doesn't go bad and stop formatting -
+        /// the rest is just discarded.
+        return traits_type::not_eof(ch);
+    }
+
+    LogStream::LogStream(LogLevel level)
+        : stream_(&buf_), active_(Logger::instance().wouldLog(level)) {
+        buf_.attach(entry_.text);
+        entry_.level = level;
+        if (!active_) {
+            /// Makes all the formatting a no-op.
+            stream_.setstate(std::ios::badbit);
+        }
+    }
+
+    LogStream::LogStream(LogStream &&other)
+        : entry_(other.entry_), stream_(&buf_), active_(other.active_) {
+        buf_.attach(entry_.text);
+        buf_.takeState(other.buf_);
+        stream_.copyfmt(other.stream_);
+        stream_.setstate(other.stream_.rdstate());
+        other.active_ = false;
+    }
+
+    LogStream::~LogStream() {
+        if (!active_) {
+            return;
+        }
+        auto len = buf_.size();
+        while (len > 0 && entry_.text[len - 1] == '\n') {
+            --len;
+        }
+        entry_.length = static_cast<std::uint16_t>(len);
+        entry_.truncated = buf_.truncated();
+        Logger::instance().submit(entry_);
+    }
+
+} // namespace vive
+} // namespace osvr
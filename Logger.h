@@ -0,0 +1,216 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_Logger_h_GUID_8D3F6A12_E57B_4C90_A1D4_2B9E7C05F361
+#define INCLUDED_Logger_h_GUID_8D3F6A12_E57B_4C90_A1D4_2B9E7C05F361
+
+// Internal Includes
+#include "MpscRing.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+/// @name Compile-time log filtering
+/// Numeric values of the LogLevel enumerators, for the preprocessor.
+/// @{
+#define OSVR_VIVE_LOG_LEVEL_TRACE 0
+#define OSVR_VIVE_LOG_LEVEL_DEBUG 1
+#define OSVR_VIVE_LOG_LEVEL_INFO 2
+#define OSVR_VIVE_LOG_LEVEL_WARN 3
+#define OSVR_VIVE_LOG_LEVEL_ERROR 4
+/// @}
+
+/// The least severe level the OSVR_VIVE_LOG_* macros compile in, normally
+/// set by the build (the OSVRVIVE_MIN_LOG_LEVEL CMake option).
+#ifndef OSVR_VIVE_LOG_MIN_LEVEL
+#define OSVR_VIVE_LOG_MIN_LEVEL OSVR_VIVE_LOG_LEVEL_TRACE
+#endif
+
+/// Log a stream insertion expression at a level:
+///
+///     OSVR_VIVE_LOG_DEBUG("Sensor " << id << " connected");
+///
+/// Unlike logDebug() and friends, the arguments are only evaluated if the
+/// message would actually be logged: not at all below the compile-time
+/// minimum level (where the whole statement compiles away), and not below
+/// the runtime level either.
+#define OSVR_VIVE_LOG(LEVEL, X)                                                \
+    do {                                                                       \
+        if (OSVR_VIVE_LOG_LEVEL_##LEVEL >= OSVR_VIVE_LOG_MIN_LEVEL &&          \
+            ::osvr::vive::Logger::instance().wouldLog(                         \
+                static_cast<::osvr::vive::LogLevel>(                           \
+                    OSVR_VIVE_LOG_LEVEL_##LEVEL))) {                           \
+            ::osvr::vive::LogStream(static_cast<::osvr::vive::LogLevel>(       \
+                OSVR_VIVE_LOG_LEVEL_##LEVEL))                                  \
+                << X;                                                          \
+        }                                                                      \
+    } while (0)
+
+#define OSVR_VIVE_LOG_TRACE(X) OSVR_VIVE_LOG(TRACE, X)
+#define OSVR_VIVE_LOG_DEBUG(X) OSVR_VIVE_LOG(DEBUG, X)
+#define OSVR_VIVE_LOG_INFO(X) OSVR_VIVE_LOG(INFO, X)
+#define OSVR_VIVE_LOG_WARN(X) OSVR_VIVE_LOG(WARN, X)
+#define OSVR_VIVE_LOG_ERROR(X) OSVR_VIVE_LOG(ERROR, X)
+
+namespace osvr {
+namespace vive {
+
+    /// Keep in sync with the OSVR_VIVE_LOG_LEVEL_* values above.
+    enum class LogLevel : std::uint8_t { Trace, Debug, Info, Warn, Error };
+
+    /// Parse a level name ("trace", "debug", "info", "warn" or "error", in
+    /// any case) into level.
+    /// @return false, leaving level alone, if the name isn't one of those.
+    bool parseLogLevel(std::string const &name, LogLevel &level);
+
+    /// One queued message. Fixed-size, so queuing one never allocates.
+    struct LogEntry {
+        static const std::size_t MAX_LENGTH = 252;
+        LogLevel level;
+        /// Set if the message didn't fit and was cut off.
+        bool truncated;
+        std::uint16_t length;
+        char text[MAX_LENGTH];
+    };
+
+    /// Writes log messages from a background thread, so the threads logging
+    /// them never wait on console I/O: they just push onto a lock-free ring.
+    /// Warnings and errors go to stderr, everything else to stdout, each
+    /// line prefixed with "[OSVR-Vive] ".
+    ///
+    /// Usually used through LogStream, via logInfo() and friends.
+    class Logger {
+      public:
+        /// The process-wide logger, started on first use.
+        static Logger &instance();
+        /// Writes out anything still queued.
+        ~Logger();
+
+        Logger(Logger const &) = delete;
+        Logger &operator=(Logger const &) = delete;
+
+        /// Messages below this level are discarded. Defaults to Info.
+        void setLevel(LogLevel level) { level_ = level; }
+        LogLevel getLevel() const { return level_; }
+        bool wouldLog(LogLevel level) const {
+            return level >= level_.load(std::memory_order_relaxed);
+        }
+
+        /// Queue a message. Never blocks: if the writer has fallen so far
+        /// behind that the queue is full, the message is dropped (and the
+        /// drop reported later). Any thread.
+        void submit(LogEntry const &entry);
+
+        /// Wait until everything queued so far has been written, for
+        /// command-line tools that are about to print output of their own.
+        void flush();
+
+      private:
+        Logger();
+        void writerThread();
+        void write(LogEntry const &entry);
+
+        MpscRing<LogEntry> ring_;
+        std::atomic<LogLevel> level_{LogLevel::Info};
+        std::atomic<std::uint64_t> submitted_{0};
+        std::atomic<std::uint64_t> written_{0};
+        std::atomic<std::uint64_t> dropped_{0};
+        std::atomic<bool> stopping_{false};
+        std::thread thread_;
+    };
+
+    /// Builds a log message with stream insertion and queues it when
+    /// destroyed, so a whole statement makes one message:
+    ///
+    ///     logInfo() << "Sensor " << id << " connected";
+    ///
+    /// Messages are single lines: a trailing newline, like from std::endl,
+    /// is dropped. Formats into a fixed-size buffer, without allocating.
+    class LogStream {
+      public:
+        explicit LogStream(LogLevel level);
+        LogStream(LogStream &&other);
+        ~LogStream();
+
+        LogStream(LogStream const &) = delete;
+        LogStream &operator=(LogStream const &) = delete;
+
+        template <typename T> LogStream &operator<<(T const &v) {
+            stream_ << v;
+            return *this;
+        }
+
+        /// For std::endl and other manipulators.
+        LogStream &operator<<(std::ostream &(*manip)(std::ostream &)) {
+            manip(stream_);
+            return *this;
+        }
+
+      private:
+        /// Writes straight into the entry's text, cutting off what doesn't
+        /// fit.
+        class Buffer : public std::streambuf {
+          public:
+            /// Start writing to the beginning of text.
+            void attach(char *text);
+            std::size_t size() const {
+                return static_cast<std::size_t>(pptr() - pbase());
+            }
+            bool truncated() const { return truncated_; }
+            /// Take on the state of another buffer whose text was copied into
+            /// ours.
+            void takeState(Buffer const &other);
+
+          protected:
+            int_type overflow(int_type ch) override;
+
+          private:
+            bool truncated_ = false;
+        };
+
+        LogEntry entry_;
+        Buffer buf_;
+        std::ostream stream_;
+        bool active_;
+    };
+
+    inline LogStream logTrace() { return LogStream(LogLevel::Trace); }
+    inline LogStream logDebug() { return LogStream(LogLevel::Debug); }
+    inline LogStream logInfo() { return LogStream(LogLevel::Info); }
+    inline LogStream logWarn() { return LogStream(LogLevel::Warn); }
+    inline LogStream logError() { return LogStream(LogLevel::Error); }
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_Logger_h_GUID_8D3F6A12_E57B_4C90_A1D4_2B9E7C05F361
@@ -0,0 +1,650 @@
+/** @file
+    @brief Implementation of a stand-in for the SteamVR Lighthouse driver, for
+    exercising the plugin (and the loader library) without any hardware.
+
+    Build with BUILD_MOCK_DRIVER, then point the plugin at the resulting
+    library with the OSVR_VIVE_DRIVER environment variable. Behavior is
+    controlled by these environment variables, read at driver init:
+
+    - OSVR_VIVE_MOCK_CONTROLLERS - number of controllers (default 2)
+    - OSVR_VIVE_MOCK_TRACKERS - number of generic tracked objects, which show
+      up a moment after startup like a hot-plugged device would (default 0)
+    - OSVR_VIVE_MOCK_BASE_STATIONS - number of base stations (default 2)
+    - OSVR_VIVE_MOCK_POSE_RATE - pose updates per second, per device
+      (default 250)
+    - OSVR_VIVE_MOCK_INPUT_RATE - button and axis events per second, per
+      controller (default 10)
+    - OSVR_VIVE_MOCK_NO_HMD - if set, report that no HMD is present.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+#include <openvr_driver.h>
+
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#define OSVR_VIVE_MOCK_EXPORT extern "C" __declspec(dllexport)
+#else
+#define OSVR_VIVE_MOCK_EXPORT                                                  \
+    extern "C" __attribute__((visibility("default")))
+#endif
+
+namespace {
+
+static const std::uint32_t INVALID_ID = 0xffffffff;
+static const double PI = 3.14159265358979323846;
+
+inline unsigned long getEnvNumber(const char *name, unsigned long defaultVal) {
+    auto val = std::getenv(name);
+    if (nullptr == val || '\0' == val[0]) {
+        return defaultVal;
+    }
+    return std::strtoul(val, nullptr, 10);
+}
+
+inline bool getEnvFlag(const char *name) {
+    auto val = std::getenv(name);
+    return nullptr != val && '\0' != val[0];
+}
+
+inline std::uint32_t copyString(std::string const &str, char *buf,
+                                std::uint32_t bufSize,
+                                vr::ETrackedPropertyError *pError) {
+    auto needed = static_cast<std::uint32_t>(str.size() + 1);
+    if (bufSize < needed) {
+        if (pError) {
+            *pError = vr::TrackedProp_BufferTooSmall;
+        }
+        return needed;
+    }
+    std::memcpy(buf, str.c_str(), needed);
+    if (pError) {
+        *pError = vr::TrackedProp_Success;
+    }
+    return needed;
+}
+
+template <typename T>
+inline T notProvided(vr::ETrackedPropertyError *pError) {
+    if (pError) {
+        *pError = vr::TrackedProp_ValueNotProvidedByDevice;
+    }
+    return T{};
+}
+
+template <typename T>
+inline T provided(T val, vr::ETrackedPropertyError *pError) {
+    if (pError) {
+        *pError = vr::TrackedProp_Success;
+    }
+    return val;
+}
+
+inline vr::HmdQuaternion_t identityQuat() {
+    vr::HmdQuaternion_t q;
+    q.w = 1;
+    q.x = q.y = q.z = 0;
+    return q;
+}
+
+/// Common parts of all mock tracked devices: identity, properties, and a
+/// made-up pose.
+class MockDevice : public vr::ITrackedDeviceServerDriver {
+  public:
+    MockDevice(std::string serial, std::string model,
+               vr::ETrackedDeviceClass deviceClass, double phase)
+        : serial_(std::move(serial)), model_(std::move(model)),
+          deviceClass_(deviceClass), phase_(phase) {}
+    virtual ~MockDevice() {}
+
+    std::string const &getSerial() const { return serial_; }
+
+    /// @return the ID we were activated with, or INVALID_ID.
+    std::uint32_t getId() const { return id_; }
+
+    /// A slow circle in front of the origin, offset per device so they don't
+    /// all pile up in one place.
+    vr::DriverPose_t computePose(double t) const {
+        vr::DriverPose_t pose;
+        std::memset(&pose, 0, sizeof(pose));
+        pose.qWorldFromDriverRotation = identityQuat();
+        pose.qDriverFromHeadRotation = identityQuat();
+        auto angle = t * 0.5 + phase_;
+        pose.vecPosition[0] = 0.3 * std::cos(angle);
+        pose.vecPosition[1] = 1.2 + 0.1 * std::sin(angle * 2);
+        pose.vecPosition[2] = -0.5 + 0.3 * std::sin(angle);
+        pose.vecVelocity[0] = -0.15 * std::sin(angle);
+        pose.vecVelocity[2] = 0.15 * std::cos(angle);
+        /// Yaw slowly about +Y.
+        pose.qRotation.w = std::cos(angle / 2);
+        pose.qRotation.x = 0;
+        pose.qRotation.y = std::sin(angle / 2);
+        pose.qRotation.z = 0;
+        pose.vecAngularVelocity[1] = 0.5;
+        pose.result = vr::TrackingResult_Running_OK;
+        pose.poseIsValid = true;
+        pose.willDriftInYaw = false;
+        pose.shouldApplyHeadModel = false;
+        pose.deviceIsConnected = true;
+        return pose;
+    }
+
+    /// @name ITrackedDeviceServerDriver
+    /// @{
+    vr::EVRInitError Activate(uint32_t unObjectId) override {
+        id_ = unObjectId;
+        return vr::VRInitError_None;
+    }
+
+    void Deactivate() override { id_ = INVALID_ID; }
+
+    void PowerOff() override {}
+
+    void *GetComponent(const char *) override { return nullptr; }
+
+    void DebugRequest(const char *, char *pchResponseBuffer,
+                      uint32_t unResponseBufferSize) override {
+        if (unResponseBufferSize > 0) {
+            pchResponseBuffer[0] = '\0';
+        }
+    }
+
+    vr::DriverPose_t GetPose() override {
+        using namespace std::chrono;
+        return computePose(duration<double>(
+                               steady_clock::now().time_since_epoch())
+                               .count());
+    }
+
+    bool
+    GetBoolTrackedDeviceProperty(vr::ETrackedDeviceProperty prop,
+                                 vr::ETrackedPropertyError *pError) override {
+        switch (prop) {
+        case vr::Prop_WillDriftInYaw_Bool:
+        case vr::Prop_DeviceIsWireless_Bool:
+        case vr::Prop_DeviceIsCharging_Bool:
+            return provided(false, pError);
+        default:
+            return notProvided<bool>(pError);
+        }
+    }
+
+    float
+    GetFloatTrackedDeviceProperty(vr::ETrackedDeviceProperty,
+                                  vr::ETrackedPropertyError *pError) override {
+        return notProvided<float>(pError);
+    }
+
+    int32_t
+    GetInt32TrackedDeviceProperty(vr::ETrackedDeviceProperty prop,
+                                  vr::ETrackedPropertyError *pError) override {
+        if (vr::Prop_DeviceClass_Int32 == prop) {
+            return provided<int32_t>(deviceClass_, pError);
+        }
+        return notProvided<int32_t>(pError);
+    }
+
+    uint64_t
+    GetUint64TrackedDeviceProperty(vr::ETrackedDeviceProperty prop,
+                                   vr::ETrackedPropertyError *pError) override {
+        if (vr::Prop_CurrentUniverseId_Uint64 == prop) {
+            return provided<uint64_t>(1, pError);
+        }
+        return notProvided<uint64_t>(pError);
+    }
+
+    vr::HmdMatrix34_t GetMatrix34TrackedDeviceProperty(
+        vr::ETrackedDeviceProperty,
+        vr::ETrackedPropertyError *pError) override {
+        return notProvided<vr::HmdMatrix34_t>(pError);
+    }
+
+    uint32_t
+    GetStringTrackedDeviceProperty(vr::ETrackedDeviceProperty prop,
+                                   char *pchValue, uint32_t unBufferSize,
+                                   vr::ETrackedPropertyError *pError) override {
+        switch (prop) {
+        case vr::Prop_SerialNumber_String:
+            return copyString(serial_, pchValue, unBufferSize, pError);
+        case vr::Prop_ModelNumber_String:
+            return copyString(model_, pchValue, unBufferSize, pError);
+        case vr::Prop_ManufacturerName_String:
+            return copyString("OSVR Mock", pchValue, unBufferSize, pError);
+        case vr::Prop_TrackingSystemName_String:
+            return copyString("lighthouse", pchValue, unBufferSize, pError);
+        default:
+            return notProvided<uint32_t>(pError);
+        }
+    }
+    /// @}
+
+  private:
+    std::string serial_;
+    std::string model_;
+    vr::ETrackedDeviceClass deviceClass_;
+    double phase_;
+    std::atomic<std::uint32_t> id_{INVALID_ID};
+};
+
+/// Numbers roughly like those of a Vive, so display-related code has
+/// something plausible to chew on.
+class MockHmd : public MockDevice, public vr::IVRDisplayComponent {
+  public:
+    MockHmd()
+        : MockDevice("MOCK-HMD-0", "Mock HMD", vr::TrackedDeviceClass_HMD,
+                     0.) {}
+
+    void *GetComponent(const char *pchComponentNameAndVersion) override {
+        if (0 == std::strcmp(pchComponentNameAndVersion,
+                             vr::IVRDisplayComponent_Version)) {
+            return static_cast<vr::IVRDisplayComponent *>(this);
+        }
+        return nullptr;
+    }
+
+    /// @name IVRDisplayComponent
+    /// @{
+    void GetWindowBounds(int32_t *pnX, int32_t *pnY, uint32_t *pnWidth,
+                         uint32_t *pnHeight) override {
+        *pnX = 0;
+        *pnY = 0;
+        *pnWidth = WIDTH;
+        *pnHeight = HEIGHT;
+    }
+
+    bool IsDisplayOnDesktop() override { return false; }
+
+    bool IsDisplayRealDisplay() override { return false; }
+
+    void GetRecommendedRenderTargetSize(uint32_t *pnWidth,
+                                        uint32_t *pnHeight) override {
+        *pnWidth = 1512;
+        *pnHeight = 1680;
+    }
+
+    void GetEyeOutputViewport(vr::EVREye eEye, uint32_t *pnX, uint32_t *pnY,
+                              uint32_t *pnWidth, uint32_t *pnHeight) override {
+        *pnX = (vr::Eye_Left == eEye) ? 0 : WIDTH / 2;
+        *pnY = 0;
+        *pnWidth = WIDTH / 2;
+        *pnHeight = HEIGHT;
+    }
+
+    void GetProjectionRaw(vr::EVREye eEye, float *pfLeft, float *pfRight,
+                          float *pfTop, float *pfBottom) override {
+        *pfLeft = (vr::Eye_Left == eEye) ? -1.39f : -1.25f;
+        *pfRight = (vr::Eye_Left == eEye) ? 1.25f : 1.39f;
+        *pfTop = -1.47f;
+        *pfBottom = 1.47f;
+    }
+
+    vr::DistortionCoordinates_t ComputeDistortion(vr::EVREye, float fU,
+                                                  float fV) override {
+        /// No distortion at all.
+        vr::DistortionCoordinates_t ret;
+        ret.rfRed[0] = ret.rfGreen[0] = ret.rfBlue[0] = fU;
+        ret.rfRed[1] = ret.rfGreen[1] = ret.rfBlue[1] = fV;
+        return ret;
+    }
+    /// @}
+
+  private:
+    static const uint32_t WIDTH = 2160;
+    static const uint32_t HEIGHT = 1200;
+};
+
+class MockController : public MockDevice, public vr::IVRControllerComponent {
+  public:
+    MockController(std::size_t i)
+        : MockDevice("MOCK-CTRL-" + std::to_string(i), "Mock Controller",
+                     vr::TrackedDeviceClass_Controller, PI * (i + 1) / 2) {}
+
+    void *GetComponent(const char *pchComponentNameAndVersion) override {
+        if (0 == std::strcmp(pchComponentNameAndVersion,
+                             vr::IVRControllerComponent_Version)) {
+            return static_cast<vr::IVRControllerComponent *>(this);
+        }
+        return nullptr;
+    }
+
+    /// Advance the canned input sequence by one step, reporting the changes
+    /// to the host.
+    void emitInput(vr::IServerDriverHost &host) {
+        auto id = getId();
+        if (INVALID_ID == id) {
+            return;
+        }
+        auto step = step_++;
+        /// Trackpad: circle around, touching for half of each revolution.
+        vr::VRControllerAxis_t trackpad;
+        trackpad.x = static_cast<float>(std::cos(step * 0.1));
+        trackpad.y = static_cast<float>(std::sin(step * 0.1));
+        host.TrackedDeviceAxisUpdated(id, 0, trackpad);
+        if (step % 32 == 0) {
+            if ((step / 32) % 2 == 0) {
+                host.TrackedDeviceButtonTouched(
+                    id, vr::k_EButton_SteamVR_Touchpad, 0.);
+            } else {
+                host.TrackedDeviceButtonUntouched(
+                    id, vr::k_EButton_SteamVR_Touchpad, 0.);
+            }
+        }
+
+        /// Trigger: ramp up and down, "clicking" at the top.
+        vr::VRControllerAxis_t trigger;
+        trigger.x = static_cast<float>((step % 20) / 19.);
+        trigger.y = 0;
+        host.TrackedDeviceAxisUpdated(id, 1, trigger);
+        if (step % 20 == 19) {
+            host.TrackedDeviceButtonPressed(id, vr::k_EButton_SteamVR_Trigger,
+                                            0.);
+        } else if (step % 20 == 0 && step > 0) {
+            host.TrackedDeviceButtonUnpressed(
+                id, vr::k_EButton_SteamVR_Trigger, 0.);
+        }
+
+        /// Every so often, tap the menu button.
+        if (step % 50 == 0) {
+            host.TrackedDeviceButtonPressed(
+                id, vr::k_EButton_ApplicationMenu, 0.);
+            host.TrackedDeviceButtonUnpressed(
+                id, vr::k_EButton_ApplicationMenu, 0.);
+        }
+    }
+
+    /// @name IVRControllerComponent
+    /// @{
+    vr::VRControllerState_t GetControllerState() override {
+        vr::VRControllerState_t state;
+        std::memset(&state, 0, sizeof(state));
+        state.unPacketNum = step_;
+        return state;
+    }
+
+    bool TriggerHapticPulse(uint32_t, uint16_t) override { return true; }
+    /// @}
+
+  private:
+    std::atomic<std::uint32_t> step_{0};
+};
+
+class MockServerProvider : public vr::IServerTrackedDeviceProvider {
+  public:
+    ~MockServerProvider() { stopThread(); }
+
+    /// @name IServerTrackedDeviceProvider
+    /// @{
+    vr::EVRInitError Init(vr::IDriverLog *, vr::IServerDriverHost *pDriverHost,
+                          const char *, const char *) override {
+        stopThread();
+        host_ = pDriverHost;
+        hmd_.reset();
+        controllers_.clear();
+        devices_.clear();
+        numLateAnnounced_ = 0;
+        auto numControllers = getEnvNumber("OSVR_VIVE_MOCK_CONTROLLERS", 2);
+        auto numTrackers = getEnvNumber("OSVR_VIVE_MOCK_TRACKERS", 0);
+        numBaseStations_ = getEnvNumber("OSVR_VIVE_MOCK_BASE_STATIONS", 2);
+        poseRate_ =
+            std::max(1ul, getEnvNumber("OSVR_VIVE_MOCK_POSE_RATE", 250));
+        inputRate_ = getEnvNumber("OSVR_VIVE_MOCK_INPUT_RATE", 10);
+
+        /// Like the real thing, we can't have more than this many devices.
+        auto maxOthers = vr::k_unMaxTrackedDeviceCount - 1;
+        numControllers = std::min<unsigned long>(numControllers, maxOthers);
+        numTrackers =
+            std::min<unsigned long>(numTrackers, maxOthers - numControllers);
+
+        hmd_ = std::make_shared<MockHmd>();
+        devices_.push_back(hmd_);
+        for (std::size_t i = 0; i < numControllers; ++i) {
+            auto ctrl = std::make_shared<MockController>(i);
+            controllers_.push_back(ctrl);
+            devices_.push_back(ctrl);
+        }
+        /// Present at startup: HMD and controllers. Trackers get announced
+        /// once we're running.
+        numStartupDevices_ = devices_.size();
+        for (std::size_t i = 0; i < numTrackers; ++i) {
+            devices_.push_back(std::make_shared<MockDevice>(
+                "MOCK-TRK-" + std::to_string(i), "Mock Tracker",
+                vr::TrackedDeviceClass_Other, PI * (i + 1) / 3));
+        }
+        return vr::VRInitError_None;
+    }
+
+    void Cleanup() override { stopThread(); }
+
+    const char *const *GetInterfaceVersions() override {
+        return INTERFACE_VERSIONS;
+    }
+
+    uint32_t GetTrackedDeviceCount() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return static_cast<uint32_t>(numAnnounced());
+    }
+
+    vr::ITrackedDeviceServerDriver *
+    GetTrackedDeviceDriver(uint32_t unWhich) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!(unWhich < numAnnounced())) {
+            return nullptr;
+        }
+        return devices_[unWhich].get();
+    }
+
+    vr::ITrackedDeviceServerDriver *
+    FindTrackedDeviceDriver(const char *pchId) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t i = 0; i < numAnnounced(); ++i) {
+            if (devices_[i]->getSerial() == pchId) {
+                return devices_[i].get();
+            }
+        }
+        /// Base stations included: like the real driver, they're announced
+        /// but can't be looked up.
+        return nullptr;
+    }
+
+    void RunFrame() override {}
+
+    bool ShouldBlockStandbyMode() override { return false; }
+
+    void EnterStandby() override {}
+
+    void LeaveStandby() override {
+        if (!thread_.joinable()) {
+            running_ = true;
+            thread_ = std::thread([this] { threadFunc(); });
+        }
+    }
+    /// @}
+
+  private:
+    std::size_t numAnnounced() const {
+        return numStartupDevices_ + numLateAnnounced_;
+    }
+
+    void stopThread() {
+        running_ = false;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    bool shouldRun() const { return running_ && !host_->IsExiting(); }
+
+    /// Does what the real driver's tracking threads do: call back with poses
+    /// and input at a steady clip.
+    void threadFunc() {
+        using clock = std::chrono::steady_clock;
+        for (std::size_t i = 0; i < numBaseStations_ && shouldRun(); ++i) {
+            host_->TrackedDeviceAdded(("LHB-MOCK" + std::to_string(i)).c_str());
+        }
+        for (std::size_t i = numStartupDevices_;
+             i < devices_.size() && shouldRun(); ++i) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ++numLateAnnounced_;
+            }
+            host_->TrackedDeviceAdded(devices_[i]->getSerial().c_str());
+        }
+
+        auto start = clock::now();
+        auto posePeriod = std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(1. / poseRate_));
+        auto inputPeriod = std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(inputRate_ ? 1. / inputRate_ : 0.));
+        auto nextPose = start;
+        auto nextInput = start;
+        while (shouldRun()) {
+            auto now = clock::now();
+            if (now >= nextPose) {
+                auto t = std::chrono::duration<double>(now - start).count();
+                for (auto &dev : devices_) {
+                    auto id = dev->getId();
+                    if (INVALID_ID != id) {
+                        host_->TrackedDevicePoseUpdated(id,
+                                                        dev->computePose(t));
+                    }
+                }
+                nextPose += posePeriod;
+                if (nextPose < now) {
+                    /// Fell behind: don't try to catch up with a burst.
+                    nextPose = now + posePeriod;
+                }
+            }
+            if (inputRate_ && now >= nextInput) {
+                for (auto &ctrl : controllers_) {
+                    ctrl->emitInput(*host_);
+                }
+                nextInput += inputPeriod;
+                if (nextInput < now) {
+                    nextInput = now + inputPeriod;
+                }
+            }
+            auto wake = inputRate_ ? std::min(nextPose, nextInput) : nextPose;
+            std::this_thread::sleep_until(wake);
+        }
+    }
+
+    static const char *const INTERFACE_VERSIONS[];
+
+    vr::IServerDriverHost *host_ = nullptr;
+    std::shared_ptr<MockHmd> hmd_;
+    std::vector<std::shared_ptr<MockController>> controllers_;
+    /// All devices, startup ones first. Fixed after Init.
+    std::vector<std::shared_ptr<MockDevice>> devices_;
+    std::size_t numStartupDevices_ = 0;
+    std::size_t numBaseStations_ = 0;
+    unsigned long poseRate_ = 250;
+    unsigned long inputRate_ = 10;
+
+    /// Protects numLateAnnounced_.
+    mutable std::mutex mutex_;
+    std::size_t numLateAnnounced_ = 0;
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+const char *const MockServerProvider::INTERFACE_VERSIONS[] = {
+    vr::ITrackedDeviceServerDriver_Version, vr::IVRDisplayComponent_Version,
+    vr::IVRControllerComponent_Version,
+    vr::IServerTrackedDeviceProvider_Version,
+    vr::IClientTrackedDeviceProvider_Version, nullptr};
+
+class MockClientProvider : public vr::IClientTrackedDeviceProvider {
+  public:
+    /// @name IClientTrackedDeviceProvider
+    /// @{
+    vr::EVRInitError Init(vr::EClientDriverMode, vr::IDriverLog *,
+                          vr::IClientDriverHost *, const char *,
+                          const char *) override {
+        return vr::VRInitError_None;
+    }
+
+    void Cleanup() override {}
+
+    bool BIsHmdPresent(const char *) override {
+        return !getEnvFlag("OSVR_VIVE_MOCK_NO_HMD");
+    }
+
+    vr::EVRInitError SetDisplayId(const char *) override {
+        return vr::VRInitError_None;
+    }
+
+    vr::HiddenAreaMesh_t GetHiddenAreaMesh(vr::EVREye,
+                                           vr::EHiddenAreaMeshType) override {
+        vr::HiddenAreaMesh_t ret;
+        ret.pVertexData = nullptr;
+        ret.unTriangleCount = 0;
+        return ret;
+    }
+
+    uint32_t GetMCImage(uint32_t *pImgWidth, uint32_t *pImgHeight,
+                        uint32_t *pChannels, void *, uint32_t) override {
+        *pImgWidth = 0;
+        *pImgHeight = 0;
+        *pChannels = 0;
+        return 0;
+    }
+    /// @}
+};
+
+MockServerProvider g_serverProvider;
+MockClientProvider g_clientProvider;
+
+} // namespace
+
+OSVR_VIVE_MOCK_EXPORT void *HmdDriverFactory(const char *pInterfaceName,
+                                             int *pReturnCode) {
+    if (0 == std::strcmp(vr::IServerTrackedDeviceProvider_Version,
+                         pInterfaceName)) {
+        return static_cast<vr::IServerTrackedDeviceProvider *>(
+            &g_serverProvider);
+    }
+    if (0 == std::strcmp(vr::IClientTrackedDeviceProvider_Version,
+                         pInterfaceName)) {
+        return static_cast<vr::IClientTrackedDeviceProvider *>(
+            &g_clientProvider);
+    }
+    if (pReturnCode) {
+        *pReturnCode = vr::VRInitError_Init_InterfaceNotFound;
+    }
+    return nullptr;
+}
@@ -0,0 +1,132 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_MpscRing_h_GUID_3F7A2C90_6D14_4B8E_95A1_C2E0B7D4F815
+#define INCLUDED_MpscRing_h_GUID_3F7A2C90_6D14_4B8E_95A1_C2E0B7D4F815
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace osvr {
+namespace vive {
+
+    /// A bounded, lock-free queue for any number of producer threads and a
+    /// single consumer thread: producers never block (a push onto a full ring
+    /// just fails), so it's safe to use from driver callbacks.
+    ///
+    /// Each slot carries a sequence number telling producers and the consumer
+    /// whose turn it is, so a producer only contends with other producers, on
+    /// a single atomic increment.
+    template <typename T> class MpscRing {
+      public:
+        using value_type = T;
+
+        /// @param capacity Rounded up to a power of two.
+        explicit MpscRing(std::size_t capacity) {
+            std::size_t n = 2;
+            while (n < capacity) {
+                n *= 2;
+            }
+            mask_ = n - 1;
+            cells_.reset(new Cell[n]);
+            for (std::size_t i = 0; i < n; ++i) {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscRing(MpscRing const &) = delete;
+        MpscRing &operator=(MpscRing const &) = delete;
+
+        std::size_t capacity() const { return mask_ + 1; }
+
+        /// Callable from any thread.
+        /// @return false if the ring was full.
+        bool tryPush(value_type const &v) {
+            auto pos = enqueuePos_.load(std::memory_order_relaxed);
+            for (;;) {
+                auto &cell = cells_[pos & mask_];
+                auto seq = cell.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(seq) -
+                            static_cast<std::ptrdiff_t>(pos);
+                if (diff == 0) {
+                    /// Slot is free for this position: try to claim it.
+                    if (enqueuePos_.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.data = v;
+                        cell.sequence.store(pos + 1,
+                                            std::memory_order_release);
+                        return true;
+                    }
+                    /// Lost the race, pos was updated: go again.
+                } else if (diff < 0) {
+                    /// Consumer hasn't freed this slot yet: full.
+                    return false;
+                } else {
+                    pos = enqueuePos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /// Consumer thread only.
+        /// @return false if the ring was empty.
+        bool tryPop(value_type &out) {
+            auto &cell = cells_[dequeuePos_ & mask_];
+            auto seq = cell.sequence.load(std::memory_order_acquire);
+            if (static_cast<std::ptrdiff_t>(seq) -
+                    static_cast<std::ptrdiff_t>(dequeuePos_ + 1) <
+                0) {
+                return false;
+            }
+            out = cell.data;
+            /// Hand the slot back to producers, one lap on.
+            cell.sequence.store(dequeuePos_ + mask_ + 1,
+                                std::memory_order_release);
+            ++dequeuePos_;
+            return true;
+        }
+
+      private:
+        struct Cell {
+            std::atomic<std::size_t> sequence;
+            value_type data;
+        };
+        std::unique_ptr<Cell[]> cells_;
+        std::size_t mask_ = 0;
+        std::atomic<std::size_t> enqueuePos_{0};
+        /// Consumer only.
+        std::size_t dequeuePos_ = 0;
+    };
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_MpscRing_h_GUID_3F7A2C90_6D14_4B8E_95A1_C2E0B7D4F815
@@ -26,7 +26,10 @@
 #include "OSVRViveTracker.h"
 #include "DriverWrapper.h"
 #include "GetComponent.h"
+#include "PoseConversion.h"
 #include "ServerPropertyHelper.h"
+#include "StartupTimeline.h"
+#include "ThreadTuning.h"
 
 // Generated JSON header file
 #include "com_osvr_Vive_json.h"
@@ -34,95 +37,101 @@
 // Library/third-party includes
 #include <boost/assert.hpp>
 #include <osvr/Util/EigenCoreGeometry.h>
-#include <osvr/Util/EigenInterop.h>
 #include <osvr/Util/TimeValue.h>
 
 // Standard includes
+#include <algorithm>
 #include <array>
-#include <chrono>
 
 namespace osvr {
 namespace vive {
 
-    namespace ei = osvr::util::eigen_interop;
-
-    /// sensor numbers in SteamVR and for tracking
-    static const auto HMD_SENSOR = 0;
+    /// Preferred sensor numbers for the first two controllers, matching the
+    /// "left" and "right" entries in com_osvr_Vive.json
     static const auto CONTROLLER_SENSORS = {1, 2};
-    static const auto MAX_CONTROLLER_ID = 2;
-
-    static const auto NUM_ANALOGS = 7;
-    static const auto NUM_BUTTONS = 14;
-
-    /// Analog sensor for the IPD
-    static const auto IPD_ANALOG = 0;
-    static const auto PROX_SENSOR_BUTTON_OFFSET = 1;
-
-    static const auto PREFIX = "[OSVR-Vive] ";
-
-    /// For the HMD and two controllers
-    static const std::array<uint32_t, 3> FIRST_BUTTON_ID = {0, 2, 8};
-    static const std::array<uint32_t, 3> FIRST_ANALOG_ID = {0, 1, 4};
-
-    /// Offsets from the first button ID for a controller that a button is
-    /// reported.
-    static const auto SYSTEM_BUTTON_OFFSET = 0;
-    static const auto MENU_BUTTON_OFFSET = 1;
-    static const auto GRIP_BUTTON_OFFSET = 2;
-    static const auto TRACKPAD_TOUCH_BUTTON_OFFSET = 3;
-    static const auto TRACKPAD_CLICK_BUTTON_OFFSET = 4;
-    static const auto TRIGGER_BUTTON_OFFSET = 4;
-
-    /// Offsets from the first button ID for a controller that an analog is
-    /// reported.
-    static const auto TRACKPAD_X_ANALOG_OFFSET = 0;
-    static const auto TRACKPAD_Y_ANALOG_OFFSET = 1;
-    static const auto TRIGGER_ANALOG_OFFSET = 2;
-
-    /// Add a util::time::TimeValue and a std::chrono::duration, returning a
-    /// TimeValue again.
-    ///
-    /// Originally from OSVR-Core
-    /// plugins/unifiedvideoinertialtracker/ThreadsafeBodyReporting.cpp but it
-    /// (or something like it) really belongs in a header of its own somewhere
-    template <typename Rep, typename Period>
-    inline util::time::TimeValue
-    operator+(util::time::TimeValue const &tv,
-              std::chrono::duration<Rep, Period> additionalTime) {
-        using namespace std::chrono;
-        using SecondsDuration = duration<OSVR_TimeValue_Seconds>;
-        using USecondsDuration =
-            duration<OSVR_TimeValue_Microseconds, std::micro>;
-        auto ret = tv;
-        auto seconds = duration_cast<SecondsDuration>(additionalTime);
-        ret.seconds += seconds.count();
-        ret.microseconds +=
-            duration_cast<USecondsDuration>(additionalTime - seconds).count();
-        osvrTimeValueNormalize(&ret);
-        return ret;
-    }
 
     /// Single, centralized routine to apply the various event time offsets - so
     /// if we're wrong about the sign to be applied, we only have to fix it in
     /// one place.
     ///
     /// @todo validate the direction of those offsets.
-    inline util::time::TimeValue
-    correctTimeByOffset(util::time::TimeValue const &tv,
-                        double eventTimeOffset) {
-        return tv + std::chrono::duration<double>(eventTimeOffset);
+    inline Timestamp correctTimeByOffset(Timestamp const &tv,
+                                         double eventTimeOffset) {
+        return tv.offsetBy(eventTimeOffset);
+    }
+
+    /// Room for this many reports of each kind between updates before the
+    /// queues have to grow: poses come in at up to about 1 kHz per device,
+    /// so this covers a long stall of the main loop with a full set of
+    /// devices.
+    static const std::size_t INITIAL_REPORT_CAPACITY = 512;
+
+    /// The OSVR device name for a device group.
+    static inline std::string groupName(std::uint32_t index) {
+        return 0 == index ? std::string("Vive")
+                          : "Vive" + std::to_string(index + 1);
+    }
+
+    /// How a sensor is named in messages: just by number in the first group.
+    static inline std::string describeSensor(DeviceGroup const &group,
+                                             std::uint32_t sensor) {
+        return 0 == group.index
+                   ? "Sensor " + std::to_string(sensor)
+                   : groupName(group.index) + " sensor " +
+                         std::to_string(sensor);
     }
 
+    DeviceGroup::DeviceGroup(ViveDriverHost &host, std::uint32_t index)
+        : host(host), index(index) {
+        trackingReports.reserve(INITIAL_REPORT_CAPACITY);
+        buttonReports.reserve(INITIAL_REPORT_CAPACITY);
+        analogReports.reserve(INITIAL_REPORT_CAPACITY);
+    }
+
+    OSVR_ReturnCode DeviceGroup::update() { return host.updateGroup(*this); }
+
     ViveDriverHost::ViveDriverHost()
         : m_universeXform(Eigen::Isometry3d::Identity()),
           m_universeRotation(Eigen::Quaterniond::Identity()) {}
 
+    ViveDriverHost::~ViveDriverHost() {
+        m_vive.reset();
+        if (m_recorder && m_recorder->getDropped() > 0) {
+            logWarn() << "Callback recording dropped "
+                      << m_recorder->getDropped()
+                      << " records because the disk couldn't keep up.";
+        }
+    }
+
     bool ViveDriverHost::start(OSVR_PluginRegContext ctx,
-                               osvr::vive::DriverWrapper &&inVive) {
+                               osvr::vive::DriverWrapper &&inVive,
+                               PluginConfig const &config) {
+        if (!startDriver(std::move(inVive), config)) {
+            return false;
+        }
+        registerDevice(ctx);
+        return true;
+    }
+
+    bool ViveDriverHost::startDriver(osvr::vive::DriverWrapper &&inVive,
+                                     PluginConfig const &config) {
+        m_config = config;
+        createGroups();
+        if (!m_config.callbackTraceFile.empty()) {
+            m_recorder.reset(new CallbackRecorder(m_config.callbackTraceFile));
+            if (m_recorder->isOpen()) {
+                logInfo() << "Recording driver callbacks to "
+                          << m_config.callbackTraceFile;
+            } else {
+                logError() << "Not recording driver callbacks: "
+                           << m_recorder->getMessage();
+                m_recorder.reset();
+            }
+        }
+        openPoseSink();
         if (!inVive) {
-            std::cerr << PREFIX << "Error: called ViveDriverHost::start() with "
-                                   "an invalid vive object!"
-                      << std::endl;
+            logError() << "Error: called ViveDriverHost::start() with an "
+                          "invalid vive object!";
         }
         /// Take ownership of the Vive.
         m_vive.reset(new osvr::vive::DriverWrapper(std::move(inVive)));
@@ -130,27 +139,22 @@ namespace vive {
         /// Finish setting up the Vive.
         try {
             if (!m_vive->startServerDeviceProvider()) {
-                std::cerr << PREFIX << "Error: could not start the server "
-                                       "device provider in the "
-                                       "Vive driver. Exiting."
-                          << std::endl;
+                logError() << "Error: could not start the server device "
+                              "provider in the Vive driver. Exiting.";
                 return false;
             }
         } catch (CouldNotGetInterface &e) {
-            std::cerr << PREFIX
-                      << "Caught exception trying to start Vive server device "
-                         "provider: "
-                      << e.what() << std::endl;
-            std::cerr << "SteamVR interface version may have "
-                         "changed, may need to be rebuilt against an updated "
-                         "header or use an older SteamVR version. Exiting."
-                      << std::endl;
+            logError() << "Caught exception trying to start Vive server "
+                          "device provider: "
+                       << e.what();
+            logError() << "SteamVR interface version may have changed, may "
+                          "need to be rebuilt against an updated header or "
+                          "use an older SteamVR version. Exiting.";
             return false;
         }
 
-        /// Power the system up.
-        m_vive->serverDevProvider().LeaveStandby();
-
+        /// Be ready for devices before powering up: from then on the driver
+        /// may add them from its own threads.
         auto handleNewDevice = [&](const char *serialNum) {
             auto dev = m_vive->serverDevProvider().FindTrackedDeviceDriver(
                 serialNum);
@@ -160,177 +164,523 @@ namespace vive {
                 if (serialNum[0] == 'L' && serialNum[1] == 'H' &&
                     serialNum[2] == 'B') {
                     /// This is one for sure.
-                    std::cout << PREFIX << "Tracked object " << serialNum
-                              << " is a Lighthouse base station" << std::endl;
+                    logInfo() << "Tracked object " << serialNum
+                              << " is a Lighthouse base station";
                     recordBaseStationSerial(serialNum);
                     return true;
                 }
-                std::cout << PREFIX << "Unrecognized tracked object "
-                          << serialNum << std::endl;
+                logInfo() << "Unrecognized tracked object " << serialNum;
                 return false;
             }
             auto ret = activateDevice(dev);
             if (!ret.first) {
-                std::cout << PREFIX << "Device with serial number " << serialNum
-                          << " couldn't be added to the devices vector."
-                          << std::endl;
+                logWarn() << "Device with serial number " << serialNum
+                          << " couldn't be added to the devices vector.";
                 return false;
             }
-            NewDeviceReport out{std::string{serialNum}, ret.second};
-            {
-                std::lock_guard<std::mutex> lock(m_mutex);
-                m_newDevices.submitNew(std::move(out), lock);
+            if (auto group = getGroup(ret.second)) {
+                NewDeviceReport out{ret.second};
+                std::lock_guard<std::mutex> lock(group->mutex);
+                group->newDevices.submitNew(std::move(out), lock);
             }
             return true;
         };
 
         m_vive->driverHost().onTrackedDeviceAdded = handleNewDevice;
 
-        /// Reserve ID 0 for the HMD
-        m_vive->devices().reserveIds(1);
+        /// Reserve the groups' IDs, the HMDs' included, for assigning
+        /// ourselves.
+        {
+            std::lock_guard<std::mutex> lock(m_channelMutex);
+            m_vive->devices().reserveIds(
+                deviceIdFor(static_cast<std::uint32_t>(m_groups.size()), 0));
+        }
+
+        /// Load the sensor IDs devices had last time, so they get them again.
+        if (!m_config.sensorIdMapFile.empty()) {
+            if (m_sensorIds.load(m_config.sensorIdMapFile)) {
+                logInfo() << "Loaded " << m_sensorIds.size()
+                          << " remembered sensor ID assignments from "
+                          << m_config.sensorIdMapFile;
+            } else {
+                logInfo() << m_sensorIds.getMessage()
+                          << " - sensor IDs will be assigned fresh.";
+            }
+        }
+
+        /// Power the system up.
+        {
+            StartupPhase phase("LeaveStandby");
+            m_vive->serverDevProvider().LeaveStandby();
+        }
 
         {
             auto numDevices =
                 m_vive->serverDevProvider().GetTrackedDeviceCount();
-            std::cout << PREFIX << "Got " << numDevices
-                      << " tracked devices at startup" << std::endl;
+            logInfo() << "Got " << numDevices << " tracked devices at startup";
             for (decltype(numDevices) i = 0; i < numDevices; ++i) {
                 auto dev = m_vive->serverDevProvider().GetTrackedDeviceDriver(
                     i);
+                if (isDeviceHeld(dev)) {
+                    /// Already added by the driver.
+                    continue;
+                }
+                StartupPhase phase("Activate[" + std::to_string(i) + "]");
                 activateDevice(dev);
             }
         }
+        saveSensorIds();
+        return true;
+    }
+
+    void ViveDriverHost::startWithoutDriver(PluginConfig const &config) {
+        m_config = config;
+        createGroups();
+        openPoseSink();
+    }
+
+    void ViveDriverHost::activateReplayedDevice(std::uint32_t id,
+                                                DeviceRole role,
+                                                std::string const &serial) {
+        auto group = getGroup(id);
+        if (!group) {
+            return;
+        }
+        m_activeDevices[id] = true;
+        routeDevice(id, role, serial);
+        NewDeviceReport out{id};
+        {
+            std::lock_guard<std::mutex> lock(group->mutex);
+            group->newDevices.submitNew(std::move(out), lock);
+        }
+    }
+
+    void ViveDriverHost::createGroups() {
+        auto count = std::max<std::uint32_t>(
+            1, std::min(m_config.maxHmds, MAX_HMDS));
+        m_groups.clear();
+        for (std::uint32_t i = 0; i < count; ++i) {
+            m_groups.emplace_back(new DeviceGroup(*this, i));
+            m_groups.back()->analogFilter.configure(
+                m_config.analogDeadband, m_config.analogChangeThreshold);
+        }
+        if (count > 1) {
+            logInfo() << "Set up to drive " << count << " HMDs at once.";
+        }
+    }
 
-        /// Finish setting this up as an OSVR device.
-        /// Create the initialization options
-        OSVR_DeviceInitOptions opts = osvrDeviceCreateInitOptions(ctx);
+    DeviceGroup *ViveDriverHost::getGroup(std::uint32_t id) const {
+        auto index = groupForDeviceId(id);
+        return index < m_groups.size() ? m_groups[index].get() : nullptr;
+    }
 
-        osvrDeviceTrackerConfigure(opts, &m_tracker);
-        osvrDeviceAnalogConfigure(opts, &m_analog, NUM_ANALOGS);
-        osvrDeviceButtonConfigure(opts, &m_button, NUM_BUTTONS);
+    bool ViveDriverHost::hasAnyHmd() const {
+        for (auto const &group : m_groups) {
+            if (hasDeviceAt(deviceIdFor(group->index, HMD_SENSOR))) {
+                return true;
+            }
+        }
+        return false;
+    }
 
-        /// Because the callbacks may not come from the same thread that
-        /// calls RunFrame, we need to be careful to not send directly from
-        /// those callbacks. We can't use an Async device token because the
-        /// waits are too long and they goof up the SteamVR Lighthouse driver.
-        m_dev.initSync(ctx, "Vive", opts);
+    void ViveDriverHost::registerDevice(OSVR_PluginRegContext ctx) {
+        if (m_groups.empty()) {
+            createGroups();
+        }
+        /// Finish setting this up as OSVR devices, one per group.
+        for (auto &group : m_groups) {
+            /// Create the initialization options
+            OSVR_DeviceInitOptions opts = osvrDeviceCreateInitOptions(ctx);
+
+            osvrDeviceTrackerConfigure(opts, &group->tracker);
+            /// Channel counts can't change once the device is initialized,
+            /// so configure for as many sensors as we could route, then
+            /// advertise just the ones in use through the descriptor.
+            osvrDeviceAnalogConfigure(opts, &group->analog, ANALOG_CAPACITY);
+            osvrDeviceButtonConfigure(opts, &group->button, BUTTON_CAPACITY);
+
+            /// Because the callbacks may not come from the same thread that
+            /// calls RunFrame, we need to be careful to not send directly
+            /// from those callbacks. We can't use an Async device token
+            /// because the waits are too long and they goof up the SteamVR
+            /// Lighthouse driver.
+            {
+                StartupPhase phase("initSync");
+                group->dev.initSync(ctx, groupName(group->index).c_str(),
+                                    opts);
+            }
 
-        /// Send JSON descriptor
-        m_dev.sendJsonDescriptor(com_osvr_Vive_json);
+            /// Send JSON descriptor
+            {
+                StartupPhase phase("sendJsonDescriptor");
+                sendDescriptor(*group);
+            }
 
-        /// Register update callback
-        m_dev.registerUpdateCallback(this);
+            /// Register update callback: the first group's does the
+            /// per-frame work as well.
+            if (0 == group->index) {
+                group->dev.registerUpdateCallback(this);
+            } else {
+                group->dev.registerUpdateCallback(group.get());
+            }
+        }
 
-        return true;
+        /// Anything that came in before now was dropped, so the first update
+        /// doesn't send a backlog of stale reports.
+        m_registered = true;
     }
     inline OSVR_ReturnCode ViveDriverHost::update() {
-        m_vive->serverDevProvider().RunFrame();
+        /// Whatever thread calls this pumps the driver.
+        tuneThreadOnce(ThreadRole::Pump);
+        if (m_vive) {
+            m_vive->serverDevProvider().RunFrame();
+        }
+        m_timeConverter.resyncIfStale();
+        auto ret = updateGroup(*m_groups.front());
+
+        /// Try guessing the universe if we don't have an HMD to actually
+        /// provide it - once per new base station sighted, rather than every
+        /// update, since nothing else changes the guess.
+        if (m_vive && 0 == m_universeId && !hasAnyHmd() &&
+            m_gotBaseStation.exchange(false)) {
+            std::vector<std::string> baseStations;
+            {
+                std::lock_guard<std::mutex> lock(m_baseStationMutex);
+                baseStations = m_baseStationSerials;
+            }
+
+            auto id = m_vive->chaperone().guessUniverseIdFromBaseStations(
+                baseStations);
+            if (0 != id) {
+                logInfo() << "No HMD attached, but guessed universe from "
+                             "sighted base stations...";
+                handleUniverseChange(id);
+            }
+        }
+        return ret;
+    }
+
+    OSVR_ReturnCode ViveDriverHost::updateGroup(DeviceGroup &group) {
+        bool gotNewDevices = false;
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
+            std::lock_guard<std::mutex> lock(group.mutex);
             /// Copy a fixed number of reports that have been queued up.
-            m_trackingReports.grabItems(lock);
-            m_buttonReports.grabItems(lock);
-            m_analogReports.grabItems(lock);
+            group.trackingReports.grabItems(lock);
+            group.buttonReports.grabItems(lock);
+            group.analogReports.grabItems(lock);
+            group.lostDevices.grabItems(lock);
+            gotNewDevices = group.newDevices.grabItems(lock) > 0;
 
         } // unlock
+        if (gotNewDevices) {
+            /// Devices activated since the last update may have needed more
+            /// channels than we've advertised, or new remembered IDs.
+            group.newDevices.clearWorkItems();
+            sendDescriptor(group);
+            saveSensorIds();
+        }
         // Now that we're out of that mutex, we can go ahead and actually send
         // the reports.
-        for (auto &out : m_trackingReports.accessWorkItems()) {
+        for (auto &out : group.trackingReports.accessWorkItems()) {
             if (out.isUniverseChange) {
                 handleUniverseChange(out.newUniverse);
             } else {
-                convertAndSendTracker(out.timestamp, out.sensor, out.report);
+                convertAndSendTracker(group, out.timestamp, out.sensor,
+                                      out.report);
             }
         }
         // then clear this temporary buffer for next time. (done automatically,
         // but doing it manually here since there will usually be lots of
         // tracking reports.
-        m_trackingReports.clearWorkItems();
+        group.trackingReports.clearWorkItems();
 
         // Deal with the button reports.
-        for (auto &out : m_buttonReports.accessWorkItems()) {
+        for (auto &out : group.buttonReports.accessWorkItems()) {
+            auto tv = m_timeConverter.toTimeValue(out.timestamp);
             osvrDeviceButtonSetValueTimestamped(
-                m_dev, m_button,
+                group.dev, group.button,
                 out.buttonState ? OSVR_BUTTON_PRESSED : OSVR_BUTTON_NOT_PRESSED,
-                out.sensor, &out.timestamp);
+                out.sensor, &tv);
         }
-        m_buttonReports.clearWorkItems();
+        group.buttonReports.clearWorkItems();
 
         // Deal with analog reports
-        for (auto &out : m_analogReports.accessWorkItems()) {
-            osvrDeviceAnalogSetValueTimestamped(m_dev, m_analog, out.value,
-                                                out.sensor, &out.timestamp);
-            if (out.secondValid) {
-                osvrDeviceAnalogSetValueTimestamped(m_dev, m_analog, out.value2,
-                                                    out.sensor + 1,
-                                                    &out.timestamp);
+        auto const &analogReports = group.analogReports.accessWorkItems();
+        if (m_config.coalesceAnalogs) {
+            /// Only the latest report for each channel needs sending.
+            for (std::size_t i = 0; i < analogReports.size(); ++i) {
+                if (analogReports[i].sensor < ANALOG_CAPACITY) {
+                    group.latestAnalogReport[analogReports[i].sensor] = i;
+                }
             }
         }
-        m_analogReports.clearWorkItems();
-
-        /// Try guessing the universe if we don't have an HMD to actually
-        /// provide it.
-        if (0 == m_universeId && !m_vive->devices().hasDeviceAt(HMD_SENSOR) &&
-            m_gotBaseStation) {
-            std::vector<std::string> baseStations;
-            {
-                std::lock_guard<std::mutex> lock(m_baseStationMutex);
-                baseStations = m_baseStationSerials;
+        for (std::size_t i = 0; i < analogReports.size(); ++i) {
+            auto &out = analogReports[i];
+            if (m_config.coalesceAnalogs && out.sensor < ANALOG_CAPACITY &&
+                group.latestAnalogReport[out.sensor] != i) {
+                continue;
             }
-
-            auto id = m_vive->chaperone().guessUniverseIdFromBaseStations(
-                baseStations);
-            if (0 != id) {
-                std::cout << PREFIX << "No HMD attached, but guessed universe "
-                                       "from sighted base stations..."
-                          << std::endl;
-                handleUniverseChange(id);
+            auto tv = m_timeConverter.toTimeValue(out.timestamp);
+            osvrDeviceAnalogSetValueTimestamped(group.dev, group.analog,
+                                                out.value, out.sensor, &tv);
+            if (out.secondValid) {
+                osvrDeviceAnalogSetValueTimestamped(group.dev, group.analog,
+                                                    out.value2, out.sensor + 1,
+                                                    &tv);
             }
         }
+        group.analogReports.clearWorkItems();
+
+        // Deal with devices reported lost by the driver, and those we haven't
+        // heard from in too long - after their last analog reports, so the
+        // zeroes sent for them are the values that stick.
+        for (auto sensor : group.lostDevices.accessWorkItems()) {
+            releaseLostDevice(group, sensor);
+        }
+        group.lostDevices.clearWorkItems();
+        checkForLostDevices(group);
+        {
+            /// Free any routing snapshots the callbacks have since let go of.
+            std::lock_guard<std::mutex> lock(m_channelMutex);
+            group.routing.reclaim();
+        }
         return OSVR_RETURN_SUCCESS;
     }
 
+    static inline DeviceRole
+    getDeviceRole(vr::ITrackedDeviceServerDriver *dev) {
+        if (getComponent<vr::IVRDisplayComponent>(dev)) {
+            return DeviceRole::HMD;
+        }
+        if (getComponent<vr::IVRControllerComponent>(dev)) {
+            return DeviceRole::Controller;
+        }
+        return DeviceRole::Other;
+    }
+
     std::pair<bool, std::uint32_t>
     ViveDriverHost::activateDevice(vr::ITrackedDeviceServerDriver *dev) {
-        auto ret = activateDeviceImpl(dev);
-        auto mfrProp = getProperty<Props::ManufacturerName>(dev);
-        auto modelProp = getProperty<Props::ModelNumber>(dev);
+        auto role = getDeviceRole(dev);
         auto serialProp = getProperty<Props::SerialNumber>(dev);
-        std::cout << PREFIX;
+        auto ret = activateDeviceImpl(dev, role, serialProp.first);
+        if (ret.first && m_recorder) {
+            m_recorder->recordDeviceAdded(ret.second,
+                                          static_cast<std::uint8_t>(role),
+                                          serialProp.first);
+        }
         if (ret.first) {
-            std::cout << "Assigned sensor ID " << ret.second << " to ";
-        } else {
-            std::cout << "Could not assign a sensor ID to ";
+            routeDevice(ret.second, role, serialProp.first);
+        }
+        auto mfrProp = getProperty<Props::ManufacturerName>(dev);
+        auto modelProp = getProperty<Props::ModelNumber>(dev);
+        {
+            auto out = logInfo();
+            if (ret.first) {
+                out << "Assigned sensor ID " << ret.second << " to ";
+            } else {
+                out << "Could not assign a sensor ID to ";
+            }
+            out << mfrProp.first << " " << modelProp.first << " "
+                << serialProp.first;
         }
-        std::cout << mfrProp.first << " " << modelProp.first << " "
-                  << serialProp.first << std::endl;
         return ret;
     }
 
     std::pair<bool, std::uint32_t>
-    ViveDriverHost::activateDeviceImpl(vr::ITrackedDeviceServerDriver *dev) {
+    ViveDriverHost::activateDeviceImpl(vr::ITrackedDeviceServerDriver *dev,
+                                       DeviceRole role,
+                                       std::string const &serial) {
         auto &devs = m_vive->devices();
-        if (getComponent<vr::IVRDisplayComponent>(dev)) {
-            /// This is the HMD, since it has the display component.
-            /// Always sensor 0.
-            return devs.addAndActivateDeviceAt(dev, HMD_SENSOR);
-        }
-        if (getComponent<vr::IVRControllerComponent>(dev)) {
-            /// This is a controller.
-            for (auto ctrlIdx : CONTROLLER_SENSORS) {
-                if (!devs.hasDeviceAt(ctrlIdx)) {
-                    return devs.addAndActivateDeviceAt(dev, ctrlIdx);
+        auto numGroups = static_cast<std::uint32_t>(m_groups.size());
+        auto groupHasHmd = [&](std::uint32_t group) {
+            return devs.hasDeviceAt(deviceIdFor(group, HMD_SENSOR));
+        };
+
+        /// Pick the ID and claim it in the device holder while holding the
+        /// lock, but don't hold it while activating: the driver may call us
+        /// back during Activate().
+        std::pair<bool, std::uint32_t> placed;
+        {
+            std::lock_guard<std::mutex> lock(m_channelMutex);
+            auto pinned = m_sensorIds.lookup(serial);
+            auto isFree = [&](std::uint32_t idx) {
+                return groupForDeviceId(idx) < numGroups &&
+                       !devs.hasDeviceAt(idx);
+            };
+            bool haveId = false;
+            std::uint32_t id = 0;
+            auto take = [&](std::uint32_t idx) {
+                id = idx;
+                haveId = true;
+            };
+            if (DeviceRole::HMD == role) {
+                /// This is an HMD, since it has the display component: always
+                /// sensor 0 of a group. The one it had last time if that's
+                /// free, otherwise the first group without an HMD that isn't
+                /// remembered for another, otherwise just the first without
+                /// one. With none free, it's left to fail as a duplicate.
+                if (pinned.first &&
+                    HMD_SENSOR == sensorForDeviceId(pinned.second) &&
+                    isFree(pinned.second)) {
+                    take(pinned.second);
+                }
+                std::uint32_t fallback = deviceIdFor(0, HMD_SENSOR);
+                bool haveFallback = false;
+                for (std::uint32_t group = 0; group < numGroups && !haveId;
+                     ++group) {
+                    auto idx = deviceIdFor(group, HMD_SENSOR);
+                    if (!isFree(idx)) {
+                        continue;
+                    }
+                    if (!m_sensorIds.claimedByOther(idx, serial)) {
+                        take(idx);
+                    } else if (!haveFallback) {
+                        fallback = idx;
+                        haveFallback = true;
+                    }
+                }
+                if (!haveId) {
+                    take(fallback);
+                }
+            }
+
+            auto isAvailable = [&](std::uint32_t idx) {
+                return HMD_SENSOR != sensorForDeviceId(idx) && isFree(idx) &&
+                       !m_sensorIds.claimedByOther(idx, serial);
+            };
+            if (!haveId && pinned.first && isAvailable(pinned.second)) {
+                /// Same ID as last time.
+                take(pinned.second);
+            }
+            if (!haveId && DeviceRole::Controller == role) {
+                /// This is a controller: it takes a left or right spot, in
+                /// the first group with an HMD that has one free, or failing
+                /// that, the first group with one free.
+                for (int pass = 0; pass < 2 && !haveId; ++pass) {
+                    for (std::uint32_t group = 0; group < numGroups && !haveId;
+                         ++group) {
+                        if (0 == pass && !groupHasHmd(group)) {
+                            continue;
+                        }
+                        for (auto ctrlIdx : CONTROLLER_SENSORS) {
+                            auto idx = deviceIdFor(
+                                group, static_cast<std::uint32_t>(ctrlIdx));
+                            if (isAvailable(idx)) {
+                                take(idx);
+                                break;
+                            }
+                        }
+                    }
                 }
             }
+            if (!haveId) {
+                /// Additional controllers and other tracked objects get the
+                /// first free ID not remembered for some other device, after
+                /// the ones set aside for the first two controllers, group by
+                /// group.
+                auto firstExtra = static_cast<std::uint32_t>(
+                    *std::max_element(begin(CONTROLLER_SENSORS),
+                                      end(CONTROLLER_SENSORS)) +
+                    1);
+                for (std::uint32_t group = 0; group < numGroups && !haveId;
+                     ++group) {
+                    for (auto sensor = firstExtra; sensor < MAX_SENSORS;
+                         ++sensor) {
+                        auto idx = deviceIdFor(group, sensor);
+                        if (isAvailable(idx)) {
+                            take(idx);
+                            break;
+                        }
+                    }
+                }
+            }
+            /// Out of routable IDs, it still gets activated: it just won't
+            /// have any channels.
+            placed = haveId ? devs.placeDeviceAt(dev, id)
+                            : devs.placeDevice(dev);
+            if (placed.first && placed.second < MAX_DEVICE_IDS) {
+                m_activeDevices[placed.second] = true;
+            }
+        }
+        if (placed.first) {
+            dev->Activate(placed.second);
         }
-        /// This still may be a controller, if somehow there are more than
-        /// 2...
-        return devs.addAndActivateDevice(dev);
+        return placed;
     }
 
-    std::ostream &ViveDriverHost::msg() const {
-        std::cout << PREFIX;
-        return std::cout;
+    void ViveDriverHost::routeDevice(std::uint32_t id, DeviceRole role,
+                                     std::string const &serial) {
+        std::lock_guard<std::mutex> lock(m_channelMutex);
+        if (!serial.empty()) {
+            m_sensorIds.assign(serial, id);
+        }
+        auto group = getGroup(id);
+        if (group && group->channels.activate(sensorForDeviceId(id), role)) {
+            group->routing.publish(group->channels);
+        } else {
+            logWarn() << "No channels available for sensor ID " << id
+                      << ", its buttons and analogs will be ignored.";
+        }
+    }
+
+    bool ViveDriverHost::isDeviceHeld(vr::ITrackedDeviceServerDriver *dev) {
+        std::lock_guard<std::mutex> lock(m_channelMutex);
+        return m_vive->devices().findDevice(dev).first;
+    }
+
+    bool ViveDriverHost::hasDeviceAt(std::uint32_t id) const {
+        return id < MAX_DEVICE_IDS && m_activeDevices[id];
+    }
+
+    void ViveDriverHost::openPoseSink() {
+        if (m_config.sharedPoseMemory.empty()) {
+            return;
+        }
+        m_poseSink.reset(new SharedPoseSink);
+        if (!m_poseSink->open(m_config.sharedPoseMemory)) {
+            m_poseSink.reset();
+        }
+    }
+
+    void ViveDriverHost::saveSensorIds() {
+        if (m_config.sensorIdMapFile.empty()) {
+            return;
+        }
+        SensorIdMap sensorIds;
+        {
+            std::lock_guard<std::mutex> lock(m_channelMutex);
+            if (!m_sensorIds.dirty()) {
+                return;
+            }
+            sensorIds = m_sensorIds;
+            m_sensorIds.setDirty(false);
+        }
+        /// Writing the file can be slow, and driver threads need the mutex to
+        /// activate devices, so save a copy with the mutex released.
+        if (!sensorIds.save(m_config.sensorIdMapFile)) {
+            logWarn() << "Could not save sensor ID assignments: "
+                      << sensorIds.getMessage();
+            /// Try again next time.
+            std::lock_guard<std::mutex> lock(m_channelMutex);
+            m_sensorIds.setDirty(true);
+        }
+    }
+
+    SensorChannels ViveDriverHost::getChannels(DeviceGroup const &group,
+                                               uint32_t unWhichDevice) {
+        auto routing = group.routing.read();
+        return routing->get(sensorForDeviceId(unWhichDevice));
+    }
+
+    void ViveDriverHost::sendDescriptor(DeviceGroup &group) {
+        std::string json;
+        {
+            std::lock_guard<std::mutex> lock(m_channelMutex);
+            /// Only the first device gets /me/head and the like.
+            json = group.channels.generateDescriptor(com_osvr_Vive_json,
+                                                     0 == group.index);
+        }
+        group.dev.sendJsonDescriptor(json);
     }
 
     void ViveDriverHost::recordBaseStationSerial(const char *serial) {
@@ -342,63 +692,82 @@ namespace vive {
     }
 
     void ViveDriverHost::submitTrackingReport(uint32_t unWhichDevice,
-                                              OSVR_TimeValue const &tv,
+                                              Timestamp const &tv,
                                               const DriverPose_t &newPose) {
+        if (!m_registered) {
+            return;
+        }
+        auto group = getGroup(unWhichDevice);
+        if (!group) {
+            return;
+        }
         TrackingReport out;
         out.timestamp = tv;
-        out.sensor = unWhichDevice;
+        out.sensor = sensorForDeviceId(unWhichDevice);
         out.report = newPose;
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_trackingReports.submitNew(std::move(out), lock);
+            std::lock_guard<std::mutex> lock(group->mutex);
+            group->trackingReports.submitNew(std::move(out), lock);
         }
     }
 
-    void ViveDriverHost::submitUniverseChange(std::uint64_t newUniverse) {
+    void ViveDriverHost::submitUniverseChange(DeviceGroup &group,
+                                              std::uint64_t newUniverse) {
         TrackingReport out;
         out.isUniverseChange = true;
         out.newUniverse = newUniverse;
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_trackingReports.submitNew(std::move(out), lock);
+            std::lock_guard<std::mutex> lock(group.mutex);
+            group.trackingReports.submitNew(std::move(out), lock);
         }
     }
 
-    void ViveDriverHost::submitButton(OSVR_ChannelCount sensor, bool state,
+    void ViveDriverHost::submitButton(DeviceGroup &group,
+                                      OSVR_ChannelCount sensor, bool state,
                                       double eventTimeOffset) {
+        if (!m_registered) {
+            return;
+        }
         ButtonReport out;
-        out.timestamp =
-            correctTimeByOffset(osvr::util::time::getNow(), eventTimeOffset);
+        out.timestamp = correctTimeByOffset(Timestamp::now(), eventTimeOffset);
         out.sensor = sensor;
         out.buttonState = state ? OSVR_BUTTON_PRESSED : OSVR_BUTTON_NOT_PRESSED;
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_buttonReports.submitNew(std::move(out), lock);
+            std::lock_guard<std::mutex> lock(group.mutex);
+            group.buttonReports.submitNew(std::move(out), lock);
         }
     }
 
-    void ViveDriverHost::submitAnalog(OSVR_ChannelCount sensor, double value) {
+    void ViveDriverHost::submitAnalog(DeviceGroup &group,
+                                      OSVR_ChannelCount sensor, double value) {
+        if (!m_registered) {
+            return;
+        }
         AnalogReport out;
-        out.timestamp = osvr::util::time::getNow();
+        out.timestamp = Timestamp::now();
         out.sensor = sensor;
         out.value = value;
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_analogReports.submitNew(std::move(out), lock);
+            std::lock_guard<std::mutex> lock(group.mutex);
+            group.analogReports.submitNew(std::move(out), lock);
         }
     }
 
-    void ViveDriverHost::submitAnalogs(OSVR_ChannelCount sensor, double value1,
+    void ViveDriverHost::submitAnalogs(DeviceGroup &group,
+                                       OSVR_ChannelCount sensor, double value1,
                                        double value2) {
+        if (!m_registered) {
+            return;
+        }
         AnalogReport out;
-        out.timestamp = osvr::util::time::getNow();
+        out.timestamp = Timestamp::now();
         out.sensor = sensor;
         out.value = value1;
         out.secondValid = true;
         out.value2 = value2;
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_analogReports.submitNew(std::move(out), lock);
+            std::lock_guard<std::mutex> lock(group.mutex);
+            group.analogReports.submitNew(std::move(out), lock);
         }
     }
     static inline const char *
@@ -425,76 +794,186 @@ namespace vive {
             break;
         }
     }
-    void ViveDriverHost::convertAndSendTracker(OSVR_TimeValue const &tv,
+    void ViveDriverHost::convertAndSendTracker(DeviceGroup &group,
+                                               Timestamp const &tv,
                                                OSVR_ChannelCount sensor,
                                                const DriverPose_t &newPose) {
-        if (!(sensor < m_trackingResults.size())) {
-            m_trackingResults.resize(sensor + 1, vr::TrackingResult_Uninitialized);
+        if (!(sensor < MAX_SENSORS) ||
+            !hasDeviceAt(deviceIdFor(group.index, sensor))) {
+            /// Out of range, or a straggler from a device that's gone.
+            return;
         }
-
-        if (newPose.result != m_trackingResults[sensor]) {
-            msg() << "Sensor " << sensor << " changed status from '"
-                  << trackingResultToString(m_trackingResults[sensor])
-                  << "' to '" << trackingResultToString(newPose.result) << "'"
-                  << std::endl;
-            m_trackingResults[sensor] = newPose.result;
+        auto &status = group.sensorStatus[sensor];
+        if (status.released) {
+            if (!newPose.deviceIsConnected) {
+                return;
+            }
+            restoreReturnedDevice(group, sensor);
+        }
+        if (newPose.result != status.result) {
+            logInfo() << describeSensor(group, sensor)
+                      << " changed status from '"
+                      << trackingResultToString(status.result) << "' to '"
+                      << trackingResultToString(newPose.result) << "'";
+            status.result = newPose.result;
+        }
+        if (newPose.deviceIsConnected) {
+            status.disconnected = false;
+        } else if (!status.disconnected) {
+            /// Start the clock on this loss.
+            status.disconnected = true;
+            status.disconnectedSince = tv;
         }
         if (!newPose.poseIsValid) {
             /// @todo better handle non-valid states?
             return;
         }
-        auto quatFromSteamVR = [](vr::HmdQuaternion_t const &q) {
-            return Eigen::Quaterniond(q.w, q.x, q.y, q.z);
-        };
+        auto pose =
+            poseFromDriver(newPose, m_universeXform, m_universeRotation);
 
-        using namespace Eigen;
+        auto sampled = correctTimeByOffset(tv, newPose.poseTimeOffset);
+        if (m_config.smoothPoseTimestamps) {
+            sampled = status.poseTimes.smooth(sampled);
+        }
+        auto correctedTimestamp = m_timeConverter.toTimeValue(sampled);
+        osvrDeviceTrackerSendPoseTimestamped(group.dev, group.tracker, &pose,
+                                             sensor, &correctedTimestamp);
+
+        PoseSample sample;
+        sample.time = sampled;
+        sample.position = Eigen::Vector3d::Map(pose.translation.data);
+        sample.orientation =
+            Eigen::Quaterniond(pose.rotation.data[0], pose.rotation.data[1],
+                               pose.rotation.data[2], pose.rotation.data[3]);
+        auto toRoom = velocityRotation(newPose, m_universeRotation);
+        sample.velocity = toRoom * Eigen::Vector3d::Map(newPose.vecVelocity);
+        sample.angularVelocity =
+            toRoom * Eigen::Vector3d::Map(newPose.vecAngularVelocity);
+        /// Only smoothed timestamps are sure to keep increasing: with raw
+        /// ones, a pose that'd go back in time is left out of the history.
+        status.history.add(sample);
+        if (m_poseSink) {
+            publishPose(group, sensor, newPose.deviceIsConnected, sample,
+                        correctedTimestamp);
+        }
+    }
 
-        auto qRotation = quatFromSteamVR(newPose.qRotation);
-
-        auto driverFromHeadRotation =
-            quatFromSteamVR(newPose.qDriverFromHeadRotation);
-
-        Translation3d driverFromHeadTranslation(
-            Vector3d::Map(newPose.vecDriverFromHeadTranslation));
-        Isometry3d driverFromHead =
-            driverFromHeadTranslation * driverFromHeadRotation;
-#if 0
-        driverFromHead.fromPositionOrientationScale(
-            Vector3d::Map(newPose.vecDriverFromHeadTranslation),
-            driverFromHeadRotation, Vector3d::Ones());
-#endif
-        auto worldFromDriverRotation =
-            quatFromSteamVR(newPose.qWorldFromDriverRotation);
-        Translation3d worldFromDriverTranslation(
-            Vector3d::Map(newPose.vecWorldFromDriverTranslation));
-        Isometry3d worldFromDriver =
-            worldFromDriverTranslation * worldFromDriverRotation;
-#if 0
-        worldFromDriver.fromPositionOrientationScale(
-            Eigen::Vector3d::Map(newPose.vecWorldFromDriverTranslation),
-            worldFromDriverRotation, Eigen::Vector3d::Ones());
-#endif
-#if 0
-        ei::map(pose.translation) =
-            (worldFromDriverTranslation * worldFromDriverRotation *
-                Eigen::Translation3d(Eigen::Vector3d::Map(newPose.vecPosition)) *
-                driverFromHeadTranslation * worldFromDriverRotation)
-            .translation();
-#endif
-
-        OSVR_Pose3 pose;
-        ei::map(pose.translation) =
-            (m_universeXform * worldFromDriver *
-             Eigen::Translation3d(Eigen::Vector3d::Map(newPose.vecPosition)) *
-             driverFromHeadTranslation)
-                .translation();
-        ei::map(pose.rotation) = m_universeRotation * worldFromDriverRotation *
-                                 qRotation * driverFromHeadRotation;
-
-        auto correctedTimestamp =
-            correctTimeByOffset(tv, newPose.poseTimeOffset);
-        osvrDeviceTrackerSendPoseTimestamped(m_dev, m_tracker, &pose, sensor,
-                                             &correctedTimestamp);
+    void ViveDriverHost::publishPose(DeviceGroup const &group,
+                                     OSVR_ChannelCount sensor, bool connected,
+                                     PoseSample const &sample,
+                                     OSVR_TimeValue const &osvrTime) {
+        namespace sp = shared_pose;
+        static_assert(sp::SENSORS_PER_DEVICE == MAX_SENSORS &&
+                          sp::DEVICE_COUNT >= MAX_HMDS,
+                      "Need a shared memory slot for every sensor");
+        sp::PoseData data;
+        data.device = group.index;
+        data.sensor = sensor;
+        data.flags = sp::POSE_VALID | (connected ? sp::DEVICE_CONNECTED : 0u);
+        data.sampleTimeUs = sample.time.microseconds();
+        data.publishTimeUs = Timestamp::now().microseconds();
+        data.osvrSeconds = osvrTime.seconds;
+        data.osvrMicroseconds = osvrTime.microseconds;
+        Eigen::Vector3d::Map(data.position) = sample.position;
+        data.orientation[0] = sample.orientation.w();
+        data.orientation[1] = sample.orientation.x();
+        data.orientation[2] = sample.orientation.y();
+        data.orientation[3] = sample.orientation.z();
+        Eigen::Vector3d::Map(data.velocity) = sample.velocity;
+        Eigen::Vector3d::Map(data.angularVelocity) = sample.angularVelocity;
+        m_poseSink->publish(data);
+    }
+
+    bool ViveDriverHost::getPoseAt(std::uint32_t id, Timestamp const &t,
+                                   PoseSample &out,
+                                   double maxExtrapolation) const {
+        auto group = getGroup(id);
+        if (!group) {
+            return false;
+        }
+        return group->sensorStatus[sensorForDeviceId(id)].history.poseAt(
+            t, out, maxExtrapolation);
+    }
+
+    void ViveDriverHost::checkForLostDevices(DeviceGroup &group) {
+        if (!(m_config.disconnectTimeout > 0)) {
+            return;
+        }
+        auto now = Timestamp::now();
+        for (std::uint32_t sensor = 0; sensor < MAX_SENSORS; ++sensor) {
+            auto &status = group.sensorStatus[sensor];
+            if (!status.disconnected || HMD_SENSOR == sensor) {
+                continue;
+            }
+            if (now.secondsSince(status.disconnectedSince) >
+                m_config.disconnectTimeout) {
+                releaseLostDevice(group, sensor);
+            }
+        }
+    }
+
+    void ViveDriverHost::releaseLostDevice(DeviceGroup &group,
+                                           std::uint32_t sensor) {
+        auto id = deviceIdFor(group.index, sensor);
+        if (HMD_SENSOR == sensor || !hasDeviceAt(id) ||
+            group.sensorStatus[sensor].released) {
+            return;
+        }
+        logInfo() << describeSensor(group, sensor)
+                  << " appears to have been disconnected, releasing its "
+                     "channels until it's back.";
+        auto const &poseTimes = group.sensorStatus[sensor].poseTimes;
+        OSVR_VIVE_LOG_DEBUG(describeSensor(group, sensor)
+                            << " had a pose period of "
+                            << poseTimes.getPeriod() * 1e3
+                            << " ms, with a delivery jitter of "
+                            << poseTimes.getJitter() * 1e3 << " ms.");
+        SensorChannels channels;
+        {
+            std::lock_guard<std::mutex> lock(m_channelMutex);
+            channels = group.channels.get(sensor);
+            if (group.channels.deactivate(sensor)) {
+                group.routing.publish(group.channels);
+            }
+        }
+        auto &status = group.sensorStatus[sensor];
+        status = SensorStatus{};
+        status.released = true;
+        status.releasedRole =
+            channels.active ? channels.role : DeviceRole::Other;
+
+        /// Let clients know: release its buttons and zero its analogs, so
+        /// nothing stays stuck, and drop it from the descriptor.
+        if (channels.active && DeviceRole::HMD != channels.role) {
+            auto now = m_timeConverter.toTimeValue(Timestamp::now());
+            for (OSVR_ChannelCount i = 0; i < CONTROLLER_NUM_BUTTONS; ++i) {
+                osvrDeviceButtonSetValueTimestamped(
+                    group.dev, group.button, OSVR_BUTTON_NOT_PRESSED,
+                    channels.firstButton + i, &now);
+            }
+            for (OSVR_ChannelCount i = 0; i < CONTROLLER_NUM_ANALOGS; ++i) {
+                osvrDeviceAnalogSetValueTimestamped(
+                    group.dev, group.analog, 0., channels.firstAnalog + i,
+                    &now);
+                group.analogFilter.reset(channels.firstAnalog + i);
+            }
+        }
+        sendDescriptor(group);
+    }
+
+    void ViveDriverHost::restoreReturnedDevice(DeviceGroup &group,
+                                               std::uint32_t sensor) {
+        auto &status = group.sensorStatus[sensor];
+        status.released = false;
+        logInfo() << describeSensor(group, sensor)
+                  << " is connected again, restoring its channels.";
+        {
+            std::lock_guard<std::mutex> lock(m_channelMutex);
+            if (group.channels.activate(sensor, status.releasedRole)) {
+                group.routing.publish(group.channels);
+            }
+        }
+        sendDescriptor(group);
     }
 
     void ViveDriverHost::handleUniverseChange(std::uint64_t newUniverse) {
@@ -505,26 +984,29 @@ namespace vive {
         if (m_universeId != 0 && newUniverse == 0) {
             /// These are usually tracking glitches, not actual changes in
             /// tracking universes.
-            std::cout << PREFIX
-                      << "Got loss of universe ID (Change of universe ID from "
+            logInfo() << "Got loss of universe ID (Change of universe ID "
+                         "from "
                       << m_universeId << " to " << newUniverse
                       << ") but will continue using existing transforms for "
-                         "optimum reliability."
-                      << std::endl;
+                         "optimum reliability.";
             return;
         }
-        std::cout << PREFIX << "Change of universe ID from " << m_universeId
-                  << " to " << newUniverse << std::endl;
+        logInfo() << "Change of universe ID from " << m_universeId << " to "
+                  << newUniverse;
         m_universeId = newUniverse;
+        /// Poses from before are in the old universe's room space.
+        for (auto &group : m_groups) {
+            for (auto &status : group->sensorStatus) {
+                status.history.clear();
+            }
+        }
         auto known = m_vive->chaperone().knowUniverseId(m_universeId);
         if (!known) {
-            std::cout << PREFIX
-                      << "No usable information on this universe "
-                         "could be found - there may not be a "
-                         "calibration for it in your room setup. You may wish "
-                         "to complete that then start the OSVR server again. "
-                         "Will operate without universe transforms."
-                      << std::endl;
+            logWarn() << "No usable information on this universe could be "
+                         "found - there may not be a calibration for it in "
+                         "your room setup. You may wish to complete that then "
+                         "start the OSVR server again. Will operate without "
+                         "universe transforms.";
             m_universeXform.setIdentity();
             m_universeRotation.setIdentity();
         }
@@ -532,10 +1014,8 @@ namespace vive {
         /// Fetch the data
         auto univData = m_vive->chaperone().getDataForUniverse(m_universeId);
         if (univData.type == osvr::vive::CalibrationType::Seated) {
-            std::cout << PREFIX
-                      << "Only a seated calibration for this universe ID "
-                         "exists: y=0 will not be at floor level."
-                      << std::endl;
+            logInfo() << "Only a seated calibration for this universe ID "
+                         "exists: y=0 will not be at floor level.";
         }
         using namespace Eigen;
         /// Populate the transforms.
@@ -548,29 +1028,49 @@ namespace vive {
 
     void ViveDriverHost::TrackedDevicePoseUpdated(uint32_t unWhichDevice,
                                                   const DriverPose_t &newPose) {
-        submitTrackingReport(unWhichDevice, osvr::util::time::getNow(),
-                             newPose);
+        tuneThreadOnce(ThreadRole::Driver);
+        if (m_recorder) {
+            m_recorder->recordPose(unWhichDevice, newPose);
+        }
+        submitTrackingReport(unWhichDevice, Timestamp::now(), newPose);
     }
 
     void ViveDriverHost::PhysicalIpdSet(uint32_t unWhichDevice,
                                         float fPhysicalIpdMeters) {
-        submitAnalog(IPD_ANALOG, fPhysicalIpdMeters);
+        tuneThreadOnce(ThreadRole::Driver);
+        if (m_recorder) {
+            m_recorder->recordIpd(unWhichDevice, fPhysicalIpdMeters);
+        }
+        if (auto group = getGroup(unWhichDevice)) {
+            submitAnalog(*group, IPD_ANALOG, fPhysicalIpdMeters);
+        }
     }
 
     void ViveDriverHost::ProximitySensorState(uint32_t unWhichDevice,
                                               bool bProximitySensorTriggered) {
-        if (unWhichDevice != 0) {
+        tuneThreadOnce(ThreadRole::Driver);
+        if (m_recorder) {
+            m_recorder->recordProximity(unWhichDevice,
+                                        bProximitySensorTriggered);
+        }
+        auto group = getGroup(unWhichDevice);
+        if (!group || sensorForDeviceId(unWhichDevice) != HMD_SENSOR) {
             return;
         }
-        submitButton(PROX_SENSOR_BUTTON_OFFSET, bProximitySensorTriggered, 0);
+        submitButton(*group, PROX_SENSOR_BUTTON_OFFSET,
+                     bProximitySensorTriggered, 0);
     }
 
     void
     ViveDriverHost::TrackedDevicePropertiesChanged(uint32_t unWhichDevice) {
+        tuneThreadOnce(ThreadRole::Driver);
+        if (m_recorder) {
+            m_recorder->recordPropertiesChanged(unWhichDevice);
+        }
         bool checkUniverse = false;
-        if (HMD_SENSOR == unWhichDevice) {
+        if (HMD_SENSOR == sensorForDeviceId(unWhichDevice)) {
             checkUniverse = true;
-        } else if (!m_vive->devices().hasDeviceAt(HMD_SENSOR)) {
+        } else if (!hasAnyHmd()) {
             checkUniverse = true;
         }
 
@@ -583,9 +1083,12 @@ namespace vive {
     std::pair<vr::ITrackedDeviceServerDriver *, bool>
     ViveDriverHost::getDriverPtr(uint32_t unWhichDevice) {
         return std::pair<vr::ITrackedDeviceServerDriver *, bool>();
-        if (m_vive->devices().hasDeviceAt(unWhichDevice)) {
-            return std::make_pair(&(m_vive->devices().getDevice(unWhichDevice)),
-                                  true);
+        {
+            std::lock_guard<std::mutex> lock(m_channelMutex);
+            if (m_vive->devices().hasDeviceAt(unWhichDevice)) {
+                return std::make_pair(
+                    &(m_vive->devices().getDevice(unWhichDevice)), true);
+            }
         }
         return std::make_pair(
             m_vive->serverDevProvider().GetTrackedDeviceDriver(
@@ -621,17 +1124,17 @@ namespace vive {
         case vr::TrackedProp_WrongDeviceClass:
             /// OK, that's realistic. We'll just not update the universe based
             /// on it.
-            std::cout << "error: TrackedProp_WrongDeviceClass when getting "
+            logWarn() << "error: TrackedProp_WrongDeviceClass when getting "
                          "universe ID from "
-                      << unWhichDevice << std::endl;
+                      << unWhichDevice;
             return;
             break;
         case vr::TrackedProp_ValueNotProvidedByDevice:
             /// OK, that's realistic. We'll just not update the universe based
             /// on it.
-            std::cout << "error: TrackedProp_ValueNotProvidedByDevice when "
+            logWarn() << "error: TrackedProp_ValueNotProvidedByDevice when "
                          "getting universe ID from "
-                      << unWhichDevice << std::endl;
+                      << unWhichDevice;
             return;
             break;
         case vr::TrackedProp_InvalidDevice:
@@ -640,19 +1143,18 @@ namespace vive {
             return;
             break;
         case vr::TrackedProp_NotYetAvailable:
-            if (HMD_SENSOR == unWhichDevice) {
+            if (HMD_SENSOR == sensorForDeviceId(unWhichDevice)) {
                 /// Well, here we want to set the universe to 0.
                 universe = 0;
             } else {
-                std::cout << "error: TrackedProp_NotYetAvailable when getting "
-                             "universe ID from "
-                          << unWhichDevice << std::endl;
+                logWarn() << "error: TrackedProp_NotYetAvailable when "
+                             "getting universe ID from "
+                          << unWhichDevice;
             }
             break;
         default:
-            std::cout << "Got unrecognized error " << err
-                      << " when getting universe ID from " << unWhichDevice
-                      << std::endl;
+            logWarn() << "Got unrecognized error " << err
+                      << " when getting universe ID from " << unWhichDevice;
             break;
         }
 
@@ -662,19 +1164,50 @@ namespace vive {
         /// the message.
         if (m_trackingThreadUniverseId != universe) {
             m_trackingThreadUniverseId = universe;
-            submitUniverseChange(universe);
+            auto group = getGroup(unWhichDevice);
+            submitUniverseChange(group ? *group : *m_groups.front(), universe);
+        }
+    }
+
+    void ViveDriverHost::VendorSpecificEvent(uint32_t unWhichDevice,
+                                             vr::EVREventType eventType,
+                                             const VREvent_Data_t &,
+                                             double eventTimeOffset) {
+        tuneThreadOnce(ThreadRole::Driver);
+        if (m_recorder) {
+            m_recorder->recordVendorEvent(unWhichDevice, eventType,
+                                          eventTimeOffset);
+        }
+        if (vr::VREvent_TrackedDeviceDeactivated != eventType) {
+            return;
         }
+        auto group = getGroup(unWhichDevice);
+        if (!group) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(group->mutex);
+        group->lostDevices.submitNew(sensorForDeviceId(unWhichDevice), lock);
     }
 
     void ViveDriverHost::TrackedDeviceButtonPressed(uint32_t unWhichDevice,
                                                     EVRButtonId eButtonId,
                                                     double eventTimeOffset) {
+        tuneThreadOnce(ThreadRole::Driver);
+        if (m_recorder) {
+            m_recorder->recordButton(trace::RecordType::ButtonPressed,
+                                     unWhichDevice, eButtonId, eventTimeOffset);
+        }
         handleTrackedButtonPressUnpress(unWhichDevice, eButtonId,
                                         eventTimeOffset, true);
     }
     void ViveDriverHost::TrackedDeviceButtonUnpressed(uint32_t unWhichDevice,
                                                       EVRButtonId eButtonId,
                                                       double eventTimeOffset) {
+        tuneThreadOnce(ThreadRole::Driver);
+        if (m_recorder) {
+            m_recorder->recordButton(trace::RecordType::ButtonUnpressed,
+                                     unWhichDevice, eButtonId, eventTimeOffset);
+        }
         handleTrackedButtonPressUnpress(unWhichDevice, eButtonId,
                                         eventTimeOffset, false);
     }
@@ -682,6 +1215,11 @@ namespace vive {
     void ViveDriverHost::TrackedDeviceButtonTouched(uint32_t unWhichDevice,
                                                     EVRButtonId eButtonId,
                                                     double eventTimeOffset) {
+        tuneThreadOnce(ThreadRole::Driver);
+        if (m_recorder) {
+            m_recorder->recordButton(trace::RecordType::ButtonTouched,
+                                     unWhichDevice, eButtonId, eventTimeOffset);
+        }
         handleTrackedButtonTouchUntouch(unWhichDevice, eButtonId,
                                         eventTimeOffset, true);
     }
@@ -689,6 +1227,11 @@ namespace vive {
     void ViveDriverHost::TrackedDeviceButtonUntouched(uint32_t unWhichDevice,
                                                       EVRButtonId eButtonId,
                                                       double eventTimeOffset) {
+        tuneThreadOnce(ThreadRole::Driver);
+        if (m_recorder) {
+            m_recorder->recordButton(trace::RecordType::ButtonUntouched,
+                                     unWhichDevice, eButtonId, eventTimeOffset);
+        }
         handleTrackedButtonTouchUntouch(unWhichDevice, eButtonId,
                                         eventTimeOffset, false);
     }
@@ -696,35 +1239,46 @@ namespace vive {
     void ViveDriverHost::TrackedDeviceAxisUpdated(
         uint32_t unWhichDevice, uint32_t unWhichAxis,
         const VRControllerAxis_t &axisState) {
-        /// Don't have allocated sensors for controllers above 2.
-        if (unWhichDevice > MAX_CONTROLLER_ID) {
+        tuneThreadOnce(ThreadRole::Driver);
+        if (m_recorder) {
+            m_recorder->recordAxis(unWhichDevice, unWhichAxis, axisState);
+        }
+        auto group = getGroup(unWhichDevice);
+        if (!group) {
             return;
         }
-        if (HMD_SENSOR == unWhichDevice) {
-            /// no axes on the HMD that we know of.
+        auto channels = getChannels(*group, unWhichDevice);
+        if (!channels.active) {
             return;
         }
-
-        const auto firstAnalogId = FIRST_ANALOG_ID[unWhichDevice];
-        switch (unWhichAxis) {
-        case 0:
-            // std::cout << "touchpad " << axisState.x << ", " << axisState.y <<
-            // std::endl;
-            submitAnalogs(firstAnalogId + TRACKPAD_X_ANALOG_OFFSET, axisState.x,
-                          axisState.y);
-            break;
-        case 1:
-            // std::cout << "trigger " << axisState.x << ", " << axisState.y <<
-            // std::endl;
-            /// trigger only uses x
-            submitAnalog(firstAnalogId + TRIGGER_ANALOG_OFFSET, axisState.x);
-            break;
-        default:
-#if 0
-            std::cout << "other axis [" << unWhichAxis << "] " << axisState.x
-                      << ", " << axisState.y << std::endl;
-#endif
-            break;
+        auto &filter = group->analogFilter;
+        auto const &map = m_config.inputMap.get(channels.role);
+        auto x = map.getAxisX(unWhichAxis);
+        auto y = map.getAxisY(unWhichAxis);
+        auto xChannel = channels.firstAnalog + x;
+        auto yChannel = channels.firstAnalog + y;
+        auto xValue = filter.applyDeadband(axisState.x);
+        auto yValue = filter.applyDeadband(axisState.y);
+        bool sendX = x != RoleInputMap::UNMAPPED &&
+                     filter.trySend(xChannel, xValue);
+        bool sendY = y != RoleInputMap::UNMAPPED &&
+                     filter.trySend(yChannel, yValue);
+        if (x != RoleInputMap::UNMAPPED && y == x + 1 && (sendX || sendY)) {
+            /// Both in one go, when they're adjacent as for the trackpad.
+            if (!sendX) {
+                filter.sent(xChannel, xValue);
+            }
+            if (!sendY) {
+                filter.sent(yChannel, yValue);
+            }
+            submitAnalogs(*group, xChannel, xValue, yValue);
+            return;
+        }
+        if (sendX) {
+            submitAnalog(*group, xChannel, xValue);
+        }
+        if (sendY) {
+            submitAnalog(*group, yChannel, yValue);
         }
     }
 
@@ -732,84 +1286,43 @@ namespace vive {
                                                          EVRButtonId eButtonId,
                                                          double eventTimeOffset,
                                                          bool state) {
-        /// Don't have allocated sensors for controllers above 2.
-        if (unWhichDevice > MAX_CONTROLLER_ID) {
+        auto group = getGroup(unWhichDevice);
+        if (!group) {
             return;
         }
-        if (HMD_SENSOR == unWhichDevice) {
-            if (eButtonId == k_EButton_System) {
-                submitButton(SYSTEM_BUTTON_OFFSET, state, eventTimeOffset);
-            }
+        auto channels = getChannels(*group, unWhichDevice);
+        if (!channels.active) {
             return;
         }
-
-        const auto firstButtonId = FIRST_BUTTON_ID[unWhichDevice];
-        switch (eButtonId) {
-        case vr::k_EButton_System:
-            submitButton(firstButtonId + SYSTEM_BUTTON_OFFSET, state,
-                         eventTimeOffset);
-            break;
-        case vr::k_EButton_ApplicationMenu:
-            submitButton(firstButtonId + MENU_BUTTON_OFFSET, state,
-                         eventTimeOffset);
-            break;
-        case vr::k_EButton_Grip:
-            submitButton(firstButtonId + GRIP_BUTTON_OFFSET, state,
-                         eventTimeOffset);
-            break;
-        case vr::k_EButton_DPad_Left:
-            /// n/a on the Vive controller
-            break;
-        case vr::k_EButton_DPad_Up:
-            /// n/a on the Vive controller
-            break;
-        case vr::k_EButton_DPad_Right:
-            /// n/a on the Vive controller
-            break;
-        case vr::k_EButton_DPad_Down:
-            /// n/a on the Vive controller
-            break;
-        case vr::k_EButton_A:
-            /// n/a on the Vive controller
-            break;
-        case vr::k_EButton_SteamVR_Touchpad:
-            submitButton(firstButtonId + TRACKPAD_CLICK_BUTTON_OFFSET, state,
-                         eventTimeOffset);
-            break;
-        case vr::k_EButton_SteamVR_Trigger:
-            submitButton(firstButtonId + TRIGGER_BUTTON_OFFSET, state,
+        auto offset = m_config.inputMap.get(channels.role).getPress(eButtonId);
+        if (offset != RoleInputMap::UNMAPPED) {
+            submitButton(*group, channels.firstButton + offset, state,
                          eventTimeOffset);
-            break;
-        default:
-            break;
         }
     }
     void ViveDriverHost::handleTrackedButtonTouchUntouch(uint32_t unWhichDevice,
                                                          EVRButtonId eButtonId,
                                                          double eventTimeOffset,
                                                          bool state) {
-        /// Don't have allocated sensors for controllers above 2.
-        if (unWhichDevice > MAX_CONTROLLER_ID) {
+        auto group = getGroup(unWhichDevice);
+        if (!group) {
             return;
         }
-
-        if (HMD_SENSOR == unWhichDevice) {
+        auto channels = getChannels(*group, unWhichDevice);
+        if (!channels.active) {
             return;
         }
-        /// Only mapping touch/untouch to a button for trackpad.
-        if (vr::k_EButton_SteamVR_Touchpad == eButtonId) {
-            submitButton(FIRST_BUTTON_ID[unWhichDevice] +
-                             TRACKPAD_TOUCH_BUTTON_OFFSET,
-                         state, eventTimeOffset);
+        auto offset = m_config.inputMap.get(channels.role).getTouch(eButtonId);
+        if (offset != RoleInputMap::UNMAPPED) {
+            submitButton(*group, channels.firstButton + offset, state,
+                         eventTimeOffset);
         }
     }
-#if 0
-    void
-    ViveDriverHost::DeviceDescriptorUpdated(std::string const &json) {
-
-        m_dev.sendJsonDescriptor(json);
+    void ViveDriverHost::DeviceDescriptorUpdated(std::string const &json) {
+        if (!m_groups.empty()) {
+            m_groups.front()->dev.sendJsonDescriptor(json);
+        }
     }
-#endif
 
 } // namespace vive
 } // namespace osvr
@@ -27,8 +27,20 @@
 #define INCLUDED_OSVRViveTracker_h_GUID_BDA684D2_7F2D_4483_660D_C9D679BB1F67
 
 // Internal Includes
+#include "AnalogFilter.h"
+#include "CacheLine.h"
+#include "CallbackRecorder.h"
+#include "Logger.h"
+#include "PluginConfig.h"
+#include "PoseHistory.h"
 #include "QuickProcessingDeque.h"
+#include "RcuPointer.h"
+#include "SensorChannels.h"
+#include "SensorIdMap.h"
 #include "ServerDriverHost.h"
+#include "SharedPoseSink.h"
+#include "Timestamp.h"
+#include "TimestampSmoother.h"
 #include <osvr/PluginKit/AnalogInterfaceC.h>
 #include <osvr/PluginKit/ButtonInterfaceC.h>
 #include <osvr/PluginKit/PluginKit.h>
@@ -41,6 +53,7 @@
 
 // Standard includes
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <iostream>
@@ -56,42 +69,155 @@ namespace vive {
         /// Only valid if isUniverseChange = true
         std::uint64_t newUniverse;
 
-        OSVR_TimeValue timestamp;
+        Timestamp timestamp;
         OSVR_ChannelCount sensor;
         vr::DriverPose_t report;
     };
 
     struct ButtonReport {
-        OSVR_TimeValue timestamp;
+        Timestamp timestamp;
         OSVR_ChannelCount sensor;
         bool buttonState;
     };
 
     struct AnalogReport {
-        OSVR_TimeValue timestamp;
+        Timestamp timestamp;
         OSVR_ChannelCount sensor;
         double value;
         bool secondValid = false;
         double value2;
     };
 
+    /// Main-thread bookkeeping on the state of each sensor.
+    struct SensorStatus {
+        vr::ETrackingResult result = vr::TrackingResult_Uninitialized;
+        /// Whether the last pose said the device wasn't connected, and if so,
+        /// since when.
+        bool disconnected = false;
+        Timestamp disconnectedSince;
+        /// Set once its channels have been released for being lost: the
+        /// driver device stays activated, so it gets them back (with this
+        /// role) when it reports being connected again.
+        bool released = false;
+        DeviceRole releasedRole = DeviceRole::Other;
+        /// Takes the delivery jitter out of pose timestamps.
+        TimestampSmoother poseTimes;
+        /// Recent poses sent, by (smoothed) sample time.
+        PoseHistory history;
+    };
+
+    /// Just the sensor ID: the serial number is already in m_sensorIds by
+    /// the time one of these is queued.
     struct NewDeviceReport {
-        std::string serialNumber;
         std::uint32_t id;
     };
 
     class DriverWrapper;
+    class ViveDriverHost;
+
+    /// One HMD and the devices that go with it: an OSVR device of its own,
+    /// with its own sensor namespace and its own report queues, so callbacks
+    /// for different HMDs never contend for a lock.
+    ///
+    /// Laid out in cache-line-aligned blocks by who writes them: what the
+    /// driver's threads write, then what the main thread does, so neither
+    /// side's writes evict the lines the other is using.
+    struct DeviceGroup {
+        OSVR_VIVE_CACHE_ALIGNED_OPERATOR_NEW
+        DeviceGroup(ViveDriverHost &host, std::uint32_t index);
+
+        /// The device's OSVR update callback.
+        OSVR_ReturnCode update();
+
+        /// @name Set at start, read-only afterwards
+        /// @{
+        ViveDriverHost &host;
+        /// Its device IDs start at index * MAX_SENSORS.
+        std::uint32_t const index;
+
+        osvr::pluginkit::DeviceToken dev;
+        OSVR_TrackerDeviceInterface tracker;
+        OSVR_AnalogDeviceInterface analog;
+        OSVR_ButtonDeviceInterface button;
+        /// @}
+
+        /// @name Producer side: written from driver callbacks
+        /// @{
+        /// Mutex-controlled, along with the pending half of each queue (the
+        /// queues keep their two halves on separate lines themselves).
+        alignas(CACHE_LINE_SIZE) std::mutex mutex;
+        QuickProcessingDeque<TrackingReport> trackingReports;
+        QuickProcessingDeque<ButtonReport> buttonReports;
+        QuickProcessingDeque<AnalogReport> analogReports;
+        /// Device IDs.
+        QuickProcessingDeque<NewDeviceReport> newDevices;
+        QuickProcessingDeque<std::uint32_t> lostDevices;
+
+        /// Immutable copy of channels for the driver callback threads to
+        /// route events with. Read without locking (but each read counts
+        /// itself in); only published (and reclaimed) while holding the
+        /// host's channel mutex.
+        alignas(CACHE_LINE_SIZE) RcuPointer<SensorChannelTable> routing;
+
+        /// Screens axis values before they're queued. Configured at start.
+        alignas(CACHE_LINE_SIZE) AnalogFilter analogFilter;
+        /// @}
+
+        /// @name Consumer side: main thread
+        /// @{
+        /// Channel assignments: controlled by the host's channel mutex, and
+        /// only changed by the driver's threads when a device is added.
+        alignas(CACHE_LINE_SIZE) SensorChannelTable channels;
+
+        std::array<SensorStatus, MAX_SENSORS> sensorStatus;
+
+        /// Scratch space for coalescing analog reports: index of the latest
+        /// report for each channel.
+        std::array<std::size_t, ANALOG_CAPACITY> latestAnalogReport;
+        /// @}
+    };
 
     class ViveDriverHost : public ServerDriverHost {
       public:
-        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        OSVR_VIVE_CACHE_ALIGNED_OPERATOR_NEW
         ViveDriverHost();
+        /// Shuts down the driver before anything its callbacks might use.
+        ~ViveDriverHost();
 
+        /// Does both startDriver() and registerDevice().
         /// @return false if we failed to start up for some reason.
         bool start(OSVR_PluginRegContext ctx,
-                   osvr::vive::DriverWrapper &&inVive);
+                   osvr::vive::DriverWrapper &&inVive,
+                   PluginConfig const &config = PluginConfig{});
 
-        /// Standard OSVR device callback
+        /// First part of startup: takes ownership of the Vive, starts the
+        /// server device provider and activates the devices found. May be
+        /// slow, and doesn't touch OSVR, so may be called from a background
+        /// thread.
+        /// @return false if we failed to start up for some reason.
+        bool startDriver(osvr::vive::DriverWrapper &&inVive,
+                         PluginConfig const &config = PluginConfig{});
+
+        /// Second part of startup: create and register the OSVR devices, one
+        /// per device group. Must be called from the thread the plugin
+        /// registration context came from, after startDriver() succeeded.
+        /// Reports from the driver are dropped until this is done.
+        void registerDevice(OSVR_PluginRegContext ctx);
+
+        /// Alternative to startDriver() for replaying recorded callbacks
+        /// (see CallbackRecorder): no driver is loaded, devices are activated
+        /// with activateReplayedDevice(), and everything else arrives by
+        /// calling the ServerDriverHost overrides directly.
+        void startWithoutDriver(PluginConfig const &config = PluginConfig{});
+
+        /// Driverless counterpart to activateDevice(), for a replayed record
+        /// of a device being activated with the given device ID (see
+        /// deviceIdFor()). Callable from the thread doing the replaying.
+        void activateReplayedDevice(std::uint32_t id, DeviceRole role,
+                                    std::string const &serial);
+
+        /// Standard OSVR device callback, for the first device group - it
+        /// also does the per-frame work for all of them.
         OSVR_ReturnCode update();
 
         /// Called when we get a new device from the SteamVR driver that we need
@@ -114,6 +240,11 @@ namespace vive {
 
         void TrackedDevicePropertiesChanged(uint32_t unWhichDevice) override;
 
+        void VendorSpecificEvent(uint32_t unWhichDevice,
+                                 vr::EVREventType eventType,
+                                 const VREvent_Data_t &eventData,
+                                 double eventTimeOffset) override;
+
         void TrackedDeviceButtonPressed(uint32_t unWhichDevice,
                                         EVRButtonId eButtonId,
                                         double eventTimeOffset) override;
@@ -134,15 +265,38 @@ namespace vive {
         TrackedDeviceAxisUpdated(uint32_t unWhichDevice, uint32_t unWhichAxis,
                                  const VRControllerAxis_t &axisState) override;
 
-        IVRSettings *GetSettings(const char *) override { return nullptr; }
-/// @}
+        /// @}
 
-#if 0
+        /// Main thread only: re-send an updated JSON device descriptor for
+        /// the first device group.
         void DeviceDescriptorUpdated(std::string const &json);
-#endif
+
+        /// Main thread only: the pose the sensor with the given device ID
+        /// (see deviceIdFor()) had at time t, in the room space, from the
+        /// poses sent for it recently - see PoseHistory::poseAt().
+        bool getPoseAt(std::uint32_t id, Timestamp const &t, PoseSample &out,
+                       double maxExtrapolation = 0.) const;
+
+        /// Number of device groups, and so the most HMDs: set at start.
+        std::size_t getGroupCount() const { return m_groups.size(); }
 
       private:
-        std::ostream &msg() const;
+        friend struct DeviceGroup;
+
+        /// Create the device groups the config asks for. Called at start,
+        /// before anything can call back.
+        void createGroups();
+
+        /// The group a device ID belongs to, or nullptr if there's no such
+        /// group. Callable from any thread once started.
+        DeviceGroup *getGroup(std::uint32_t id) const;
+
+        /// Whether any group has its HMD.
+        bool hasAnyHmd() const;
+
+        /// Send a group's queued reports: its update callback.
+        OSVR_ReturnCode updateGroup(DeviceGroup &group);
+
         /// called from tracker thread, handles locking.
         void recordBaseStationSerial(const char *serial);
 
@@ -170,66 +324,145 @@ namespace vive {
 
         /// Does the real work of adding a new device.
         std::pair<bool, std::uint32_t>
-        activateDeviceImpl(vr::ITrackedDeviceServerDriver *dev);
+        activateDeviceImpl(vr::ITrackedDeviceServerDriver *dev,
+                           DeviceRole role, std::string const &serial);
 
-        osvr::pluginkit::DeviceToken m_dev;
-        OSVR_TrackerDeviceInterface m_tracker;
-        OSVR_AnalogDeviceInterface m_analog;
-        OSVR_ButtonDeviceInterface m_button;
+        /// Remember the device's sensor ID and give it channels.
+        void routeDevice(std::uint32_t id, DeviceRole role,
+                         std::string const &serial);
 
-        std::unique_ptr<osvr::vive::DriverWrapper> m_vive;
+        /// Whether the driver's device holder has this device already.
+        bool isDeviceHeld(vr::ITrackedDeviceServerDriver *dev);
 
-        /// Cached copy of the universe ID only touched from tracking thread
-        /// callbacks
-        std::uint64_t m_trackingThreadUniverseId = 0;
+        /// Whether a device is activated at this sensor ID - in the driver, or
+        /// in the replay if there's no driver. Lock-free, so callable from any
+        /// thread.
+        bool hasDeviceAt(std::uint32_t id) const;
+
+        /// Open the shared memory pose sink, if configured.
+        void openPoseSink();
+
+        /// Persist the sensor ID map, if it changed. Does file I/O (on a copy,
+        /// outside m_channelMutex), so only called at startup and when devices
+        /// are added - never from two threads at once.
+        void saveSensorIds();
+
+        /// Get a copy of the channel assignment for a device from its
+        /// group's current routing snapshot - lock-free, so callable from
+        /// any thread.
+        SensorChannels getChannels(DeviceGroup const &group,
+                                   uint32_t unWhichDevice);
+
+        /// Regenerate a group's descriptor from its channel table and send
+        /// it.
+        void sendDescriptor(DeviceGroup &group);
 
         /// Can be called from steamvr thread.
-        void submitTrackingReport(uint32_t unWhichDevice,
-                                  OSVR_TimeValue const &tv,
+        void submitTrackingReport(uint32_t unWhichDevice, Timestamp const &tv,
                                   const DriverPose_t &newPose);
 
-        void submitUniverseChange(std::uint64_t newUniverse);
+        /// Queued with the reporting device's group, in order with its
+        /// poses.
+        void submitUniverseChange(DeviceGroup &group,
+                                  std::uint64_t newUniverse);
 
-        void submitButton(OSVR_ChannelCount sensor, bool state,
-                          double eventTimeOffset = 0.);
+        void submitButton(DeviceGroup &group, OSVR_ChannelCount sensor,
+                          bool state, double eventTimeOffset = 0.);
 
-        void submitAnalog(OSVR_ChannelCount sensor, double value);
+        void submitAnalog(DeviceGroup &group, OSVR_ChannelCount sensor,
+                          double value);
         /// Submit both axes for a single mutex lock.
-        void submitAnalogs(OSVR_ChannelCount sensor, double value1,
-                           double value2);
+        void submitAnalogs(DeviceGroup &group, OSVR_ChannelCount sensor,
+                           double value1, double value2);
 
-        /// @name Mutex-controlled
+        /// @name Main-thread only
         /// @{
-        std::mutex m_mutex;
-        QuickProcessingDeque<TrackingReport> m_trackingReports;
-        QuickProcessingDeque<ButtonReport> m_buttonReports;
-        QuickProcessingDeque<AnalogReport> m_analogReports;
-        QuickProcessingDeque<NewDeviceReport> m_newDevices;
+        /// Current reports - main thread only
+        /// Called from main thread only!
+        void convertAndSendTracker(DeviceGroup &group, Timestamp const &tv,
+                                   OSVR_ChannelCount sensor,
+                                   const DriverPose_t &newPose);
+        /// Write a pose just sent to the shared memory sink as well.
+        void publishPose(DeviceGroup const &group, OSVR_ChannelCount sensor,
+                         bool connected, PoseSample const &sample,
+                         OSVR_TimeValue const &osvrTime);
+        void handleUniverseChange(std::uint64_t newUniverse);
+
+        /// Release a group's devices that have reported being disconnected
+        /// for longer than the configured timeout.
+        void checkForLostDevices(DeviceGroup &group);
+
+        /// Release a lost (non-HMD) device's channels and let clients know
+        /// it's gone. The driver device stays activated and keeps its ID, since
+        /// the driver won't add it again when it comes back.
+        void releaseLostDevice(DeviceGroup &group, std::uint32_t sensor);
+
+        /// Give a released device its channels back, now that it's reported
+        /// being connected again.
+        void restoreReturnedDevice(DeviceGroup &group, std::uint32_t sensor);
+        /// @}
+
+        // The data is laid out in cache-line-aligned blocks by which threads
+        // write it, so the driver's threads reporting at a kilohertz or more
+        // don't keep evicting the lines the main thread reads as it sends,
+        // and vice versa.
+
+        /// @name Set at start, read-only afterwards
+        /// @{
+        /// Never resized after start: the callbacks find their group here
+        /// without locking.
+        std::vector<std::unique_ptr<DeviceGroup>> m_groups;
+
+        std::unique_ptr<osvr::vive::DriverWrapper> m_vive;
+
+        PluginConfig m_config;
+
+        /// Set once the OSVR device exists and reports can be sent.
+        std::atomic<bool> m_registered{false};
+
+        /// Records driver callbacks, if configured.
+        std::unique_ptr<CallbackRecorder> m_recorder;
+
+        /// Publishes poses to shared memory, if configured. Written through
+        /// from the main thread only.
+        std::unique_ptr<SharedPoseSink> m_poseSink;
+
+        OSVR_PluginRegContext m_ctx;
         /// @}
 
-        bool m_gotBaseStation = false;
-        /// @name Base station serials (mutex controlled)
+        /// @name Producer side: written from the driver's threads
         /// @{
+        /// Cached copy of the universe ID only touched from tracking thread
+        /// callbacks
+        alignas(CACHE_LINE_SIZE) std::uint64_t m_trackingThreadUniverseId = 0;
+
+        /// Set when a base station is added, cleared when the main thread
+        /// takes the serials to guess the universe from.
+        std::atomic<bool> m_gotBaseStation{false};
+        /// Base station serials (mutex controlled)
         std::mutex m_baseStationMutex;
         std::vector<std::string> m_baseStationSerials;
+
+        /// Which IDs have a device, for checking without locking: mirrors
+        /// the driver's device holder, which is only touched while holding
+        /// m_channelMutex, or stands in for it when replaying.
+        std::array<std::atomic<bool>, MAX_DEVICE_IDS> m_activeDevices{};
         /// @}
 
-        /// @name Main-thread only
+        /// @name Consumer side: main thread
         /// @{
-        /// Current reports - main thread only
-        /// Called from main thread only!
-        void convertAndSendTracker(OSVR_TimeValue const &tv,
-                                   OSVR_ChannelCount sensor,
-                                   const DriverPose_t &newPose);
-        void handleUniverseChange(std::uint64_t newUniverse);
+        /// Sensor channel and ID assignments (mutex controlled), along with
+        /// each group's channels. Taken by the main thread every update, but
+        /// by the driver's threads only when a device is added.
+        alignas(CACHE_LINE_SIZE) std::mutex m_channelMutex;
+        SensorIdMap m_sensorIds;
 
-        OSVR_PluginRegContext m_ctx;
+        /// Turns report timestamps into OSVR time values as they're sent.
+        TimestampConverter m_timeConverter;
 
         std::uint64_t m_universeId = 0;
         Eigen::Isometry3d m_universeXform;
         Eigen::Quaterniond m_universeRotation;
-        std::vector<vr::ETrackingResult> m_trackingResults;
-
         /// @}
     };
     using DriverHostPtr = std::unique_ptr<ViveDriverHost>;
@@ -0,0 +1,204 @@
+/** @file
+    @brief Implementation
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "PluginConfig.h"
+#include "Logger.h"
+#include "SensorChannels.h"
+
+// Library/third-party includes
+#include <json/reader.h>
+#include <json/value.h>
+
+// Standard includes
+#include <vector>
+
+namespace osvr {
+namespace vive {
+    static inline void warnBadValue(const char *key) {
+        logWarn() << "Ignoring " << CONFIG_DRIVER_NAME << " parameter \""
+                  << key << "\": unexpected type, using default.";
+    }
+
+    static inline void readString(Json::Value const &root, const char *key,
+                                  std::string &out) {
+        auto const &val = root[key];
+        if (val.isNull()) {
+            return;
+        }
+        if (!val.isString()) {
+            warnBadValue(key);
+            return;
+        }
+        out = val.asString();
+    }
+
+    static inline void readDouble(Json::Value const &root, const char *key,
+                                  double &out) {
+        auto const &val = root[key];
+        if (val.isNull()) {
+            return;
+        }
+        if (!val.isNumeric()) {
+            warnBadValue(key);
+            return;
+        }
+        out = val.asDouble();
+    }
+
+    static inline void readUInt(Json::Value const &root, const char *key,
+                                std::uint32_t &out) {
+        auto const &val = root[key];
+        if (val.isNull()) {
+            return;
+        }
+        if (!val.isUInt()) {
+            warnBadValue(key);
+            return;
+        }
+        out = val.asUInt();
+    }
+
+    static inline void readBool(Json::Value const &root, const char *key,
+                                bool &out) {
+        auto const &val = root[key];
+        if (val.isNull()) {
+            return;
+        }
+        if (!val.isBool()) {
+            warnBadValue(key);
+            return;
+        }
+        out = val.asBool();
+    }
+
+    static inline void warnBadMember(const char *key, const char *member,
+                                     const char *problem) {
+        logWarn() << "Ignoring " << CONFIG_DRIVER_NAME << " parameter \""
+                  << key << "." << member << "\": " << problem
+                  << ", using default.";
+    }
+
+    static inline void readThreadSettings(Json::Value const &root,
+                                          const char *key,
+                                          ThreadSettings &out) {
+        auto const &val = root[key];
+        if (val.isNull()) {
+            return;
+        }
+        if (!val.isObject()) {
+            warnBadValue(key);
+            return;
+        }
+        auto const &priority = val["realtimePriority"];
+        if (!priority.isNull()) {
+            if (priority.isInt() && priority.asInt() >= 1 &&
+                priority.asInt() <= 99) {
+                out.realtimePriority = priority.asInt();
+            } else {
+                warnBadMember(key, "realtimePriority",
+                              "must be a whole number from 1 to 99");
+            }
+        }
+        auto const &nice = val["nice"];
+        if (!nice.isNull()) {
+            if (nice.isInt() && nice.asInt() >= -20 && nice.asInt() <= 19) {
+                out.setNice = true;
+                out.nice = nice.asInt();
+            } else {
+                warnBadMember(key, "nice",
+                              "must be a whole number from -20 to 19");
+            }
+        }
+        auto const &cpus = val["cpus"];
+        if (!cpus.isNull()) {
+            std::vector<unsigned> list;
+            bool ok = cpus.isArray();
+            for (Json::ArrayIndex i = 0; ok && i < cpus.size(); ++i) {
+                ok = cpus[i].isUInt();
+                if (ok) {
+                    list.push_back(cpus[i].asUInt());
+                }
+            }
+            if (ok) {
+                out.cpus = list;
+            } else {
+                warnBadMember(key, "cpus", "must be an array of CPU numbers");
+            }
+        }
+    }
+
+    static inline void readLogLevel(Json::Value const &root, const char *key,
+                                    LogLevel &out) {
+        std::string name;
+        readString(root, key, name);
+        if (!name.empty() && !parseLogLevel(name, out)) {
+            logWarn() << "Ignoring " << CONFIG_DRIVER_NAME << " parameter \""
+                      << key << "\": unknown level \"" << name
+                      << "\", using default.";
+        }
+    }
+
+    PluginConfig parsePluginConfig(std::string const &json) {
+        PluginConfig ret;
+        if (json.empty()) {
+            return ret;
+        }
+        Json::Value root;
+        Json::Reader reader;
+        if (!reader.parse(json, root) || !root.isObject()) {
+            logWarn() << "Could not parse " << CONFIG_DRIVER_NAME
+                      << " params, using defaults: "
+                      << reader.getFormattedErrorMessages();
+            return ret;
+        }
+        readString(root, "sensorIdMapFile", ret.sensorIdMapFile);
+        readDouble(root, "disconnectTimeout", ret.disconnectTimeout);
+        readDouble(root, "detectWait", ret.detectWait);
+        readString(root, "startupTraceFile", ret.startupTraceFile);
+        readString(root, "callbackTraceFile", ret.callbackTraceFile);
+        readBool(root, "smoothPoseTimestamps", ret.smoothPoseTimestamps);
+        readString(root, "sharedPoseMemory", ret.sharedPoseMemory);
+        readUInt(root, "maxHmds", ret.maxHmds);
+        if (ret.maxHmds < 1 || ret.maxHmds > MAX_HMDS) {
+            logWarn() << "Ignoring " << CONFIG_DRIVER_NAME
+                      << " parameter \"maxHmds\": must be from 1 to "
+                      << MAX_HMDS << ", using default.";
+            ret.maxHmds = 1;
+        }
+        readThreadSettings(root, "pumpThread", ret.pumpThread);
+        readThreadSettings(root, "driverThreads", ret.driverThreads);
+        readThreadSettings(root, "workerThreads", ret.workerThreads);
+        readLogLevel(root, "logLevel", ret.logLevel);
+        readDouble(root, "analogDeadband", ret.analogDeadband);
+        readDouble(root, "analogChangeThreshold", ret.analogChangeThreshold);
+        readBool(root, "coalesceAnalogs", ret.coalesceAnalogs);
+        if (root.isMember("inputMap")) {
+            ret.inputMap.load(root["inputMap"]);
+        }
+        return ret;
+    }
+
+} // namespace vive
+} // namespace osvr
@@ -0,0 +1,128 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PluginConfig_h_GUID_2C5F8E17_A63D_4B90_9E41_D07B3A1F6C28
+#define INCLUDED_PluginConfig_h_GUID_2C5F8E17_A63D_4B90_9E41_D07B3A1F6C28
+
+// Internal Includes
+#include "InputMap.h"
+#include "Logger.h"
+#include "ThreadTuning.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cstdint>
+#include <string>
+
+namespace osvr {
+namespace vive {
+
+    /// Name of the (optional) driver entry in the OSVR server config whose
+    /// params configure this plugin.
+    static const auto CONFIG_DRIVER_NAME = "ViveConfig";
+
+    /// Options from the "params" object of a ViveConfig driver entry. Every
+    /// field has a usable default, so the entry can be left out entirely.
+    struct PluginConfig {
+        /// File in which to persist serial number to sensor ID assignments,
+        /// relative to the server's working directory (normally where its
+        /// config file lives). Empty to disable.
+        std::string sensorIdMapFile = "osvr_vive_sensor_ids.json";
+
+        /// Seconds a device (other than the HMD) may report being
+        /// disconnected before its channels are released, until it reports
+        /// being connected again. 0 to never release them.
+        double disconnectTimeout = 5.;
+
+        /// Hardware detection loads and starts the driver on a background
+        /// thread: this is how many seconds a detect waits for it, so a quick
+        /// startup still registers the device right away. A slower startup
+        /// (or any startup, if this is 0) only gets registered on a later
+        /// detect, which the server may never run on its own.
+        double detectWait = 1.;
+
+        /// If not empty, where to write a Chrome trace JSON file of the
+        /// phases of driver startup. A one-line summary is always printed.
+        std::string startupTraceFile;
+
+        /// If not empty, record every driver callback to this binary file
+        /// (appending a new session if it already holds a compatible trace).
+        std::string callbackTraceFile;
+
+        /// Whether to take the jitter in when poses arrive from the driver
+        /// out of their timestamps, by following each device's sampling
+        /// schedule.
+        bool smoothPoseTimestamps = true;
+
+        /// If not empty, the POSIX shared memory name (like
+        /// "/osvr-vive-poses") to publish each sensor's latest pose to, for
+        /// local processes to read without going through OSVR. Not
+        /// available on Windows.
+        std::string sharedPoseMemory;
+
+        /// How many HMDs to drive at once, up to MAX_HMDS. Each gets an OSVR
+        /// device of its own, "Vive" for the first, then "Vive2" and so on,
+        /// all created at startup.
+        std::uint32_t maxHmds = 1;
+
+        /// Scheduling priority and CPU affinity (Linux only) for the thread
+        /// that pumps the driver - the server's, which calls our update - for
+        /// the driver's threads that call back into the plugin, applied on
+        /// each one's first callback, and for the plugin's own background
+        /// threads.
+        ThreadSettings pumpThread;
+        ThreadSettings driverThreads;
+        ThreadSettings workerThreads;
+
+        /// Least severe level of messages to print. Levels below the one the
+        /// plugin was built with (see OSVRVIVE_MIN_LOG_LEVEL) can't be
+        /// turned back on here.
+        LogLevel logLevel = LogLevel::Info;
+
+        /// How driver buttons and axes map onto OSVR channels.
+        InputMap inputMap;
+
+        /// Axis values within this distance of zero are reported as zero.
+        double analogDeadband = 0.;
+
+        /// An axis value is only reported if it differs from the last one
+        /// reported on its channel by more than this; at 0, only exact
+        /// repeats are dropped.
+        double analogChangeThreshold = 0.;
+
+        /// Send only the latest value for each analog channel per update,
+        /// rather than every value queued since the last.
+        bool coalesceAnalogs = true;
+    };
+
+    /// Parse the params JSON. Unrecognized or malformed values are reported
+    /// to the console and left at their defaults.
+    PluginConfig parsePluginConfig(std::string const &json);
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_PluginConfig_h_GUID_2C5F8E17_A63D_4B90_9E41_D07B3A1F6C28
@@ -0,0 +1,96 @@
+/** @file
+    @brief Header for converting driver poses into OSVR poses, kept apart
+    from the driver host so it can be benchmarked on its own.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PoseConversion_h_GUID_2C7A9E51_0B3D_4F68_8D14_5E6F93A1C7B2
+#define INCLUDED_PoseConversion_h_GUID_2C7A9E51_0B3D_4F68_8D14_5E6F93A1C7B2
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+#include <openvr_driver.h>
+#include <osvr/Util/ClientReportTypesC.h>
+#include <osvr/Util/EigenCoreGeometry.h>
+#include <osvr/Util/EigenInterop.h>
+
+// Standard includes
+// - none
+
+namespace osvr {
+namespace vive {
+
+    inline Eigen::Quaterniond quatFromSteamVR(vr::HmdQuaternion_t const &q) {
+        return Eigen::Quaterniond(q.w, q.x, q.y, q.z);
+    }
+
+    /// The pose a driver reports, in the OSVR room space: the driver's
+    /// world-from-driver and driver-from-head transforms applied, then the
+    /// universe's calibration (whose rotation part is passed separately,
+    /// since it's all the orientation needs).
+    inline OSVR_Pose3
+    poseFromDriver(vr::DriverPose_t const &newPose,
+                   Eigen::Isometry3d const &universeXform,
+                   Eigen::Quaterniond const &universeRotation) {
+        namespace ei = osvr::util::eigen_interop;
+        using namespace Eigen;
+
+        auto qRotation = quatFromSteamVR(newPose.qRotation);
+
+        auto driverFromHeadRotation =
+            quatFromSteamVR(newPose.qDriverFromHeadRotation);
+        Translation3d driverFromHeadTranslation(
+            Vector3d::Map(newPose.vecDriverFromHeadTranslation));
+
+        auto worldFromDriverRotation =
+            quatFromSteamVR(newPose.qWorldFromDriverRotation);
+        Translation3d worldFromDriverTranslation(
+            Vector3d::Map(newPose.vecWorldFromDriverTranslation));
+        Isometry3d worldFromDriver =
+            worldFromDriverTranslation * worldFromDriverRotation;
+
+        OSVR_Pose3 pose;
+        ei::map(pose.translation) =
+            (universeXform * worldFromDriver *
+             Translation3d(Vector3d::Map(newPose.vecPosition)) *
+             driverFromHeadTranslation)
+                .translation();
+        ei::map(pose.rotation) = universeRotation * worldFromDriverRotation *
+                                 qRotation * driverFromHeadRotation;
+        return pose;
+    }
+
+    /// The rotation taking the driver's velocities (linear and angular, taken
+    /// to be in its world space, like the position) into the OSVR room space.
+    inline Eigen::Quaterniond
+    velocityRotation(vr::DriverPose_t const &newPose,
+                     Eigen::Quaterniond const &universeRotation) {
+        return universeRotation *
+               quatFromSteamVR(newPose.qWorldFromDriverRotation);
+    }
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_PoseConversion_h_GUID_2C7A9E51_0B3D_4F68_8D14_5E6F93A1C7B2
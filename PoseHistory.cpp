@@ -0,0 +1,124 @@
+/** @file
+    @brief Implementation
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "PoseHistory.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+// - none
+
+namespace osvr {
+namespace vive {
+    static_assert((PoseHistory::CAPACITY & (PoseHistory::CAPACITY - 1)) == 0,
+                  "PoseHistory::CAPACITY must be a power of two");
+
+    bool PoseHistory::add(PoseSample const &sample) {
+        if (!empty() &&
+            sample.time.microseconds() <= newest().time.microseconds()) {
+            return false;
+        }
+        if (size_ < CAPACITY) {
+            samples_[(start_ + size_) & (CAPACITY - 1)] = sample;
+            size_++;
+        } else {
+            /// Full: the new one takes the oldest's place.
+            samples_[start_] = sample;
+            start_ = (start_ + 1) & (CAPACITY - 1);
+        }
+        return true;
+    }
+
+    bool PoseHistory::poseAt(Timestamp const &t, PoseSample &out,
+                             double maxExtrapolation) const {
+        if (empty()) {
+            return false;
+        }
+        auto us = t.microseconds();
+        if (us < oldest().time.microseconds()) {
+            return false;
+        }
+        auto const &last = newest();
+        if (us >= last.time.microseconds()) {
+            if (t.secondsSince(last.time) > maxExtrapolation) {
+                return false;
+            }
+            out = extrapolate(last, t);
+            return true;
+        }
+        /// Find the first sample later than t: there is one, and it isn't
+        /// the oldest, so t lies between it and the one before.
+        std::size_t lo = 1;
+        std::size_t hi = size_ - 1;
+        while (lo < hi) {
+            auto mid = lo + (hi - lo) / 2;
+            if (at(mid).time.microseconds() > us) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        auto const &before = at(lo - 1);
+        auto const &after = at(lo);
+        out = interpolate(before, after, t.secondsSince(before.time) /
+                                             after.time.secondsSince(
+                                                 before.time));
+        out.time = t;
+        return true;
+    }
+
+    PoseSample interpolate(PoseSample const &a, PoseSample const &b,
+                           double alpha) {
+        PoseSample ret;
+        ret.time = a.time.offsetBy(alpha * b.time.secondsSince(a.time));
+        ret.position = a.position + alpha * (b.position - a.position);
+        ret.orientation = a.orientation.slerp(alpha, b.orientation);
+        ret.velocity = a.velocity + alpha * (b.velocity - a.velocity);
+        ret.angularVelocity =
+            a.angularVelocity + alpha * (b.angularVelocity - a.angularVelocity);
+        return ret;
+    }
+
+    PoseSample extrapolate(PoseSample const &sample, Timestamp const &t) {
+        auto dt = t.secondsSince(sample.time);
+        PoseSample ret = sample;
+        ret.time = t;
+        ret.position += dt * sample.velocity;
+        auto angle = sample.angularVelocity.norm() * dt;
+        if (angle != 0.) {
+            /// Angular velocity is in the room space, so the rotation it
+            /// makes applies on the left.
+            ret.orientation =
+                (Eigen::Quaterniond(Eigen::AngleAxisd(
+                     angle, sample.angularVelocity.normalized())) *
+                 sample.orientation)
+                    .normalized();
+        }
+        return ret;
+    }
+
+} // namespace vive
+} // namespace osvr
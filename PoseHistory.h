@@ -0,0 +1,112 @@
+/** @file
+    @brief Header for a fixed-size history of a sensor's poses, for asking
+    where it was at a given time.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PoseHistory_h_GUID_6D2B8F40_91E7_4C3A_B5F6_0A83E2C7D915
+#define INCLUDED_PoseHistory_h_GUID_6D2B8F40_91E7_4C3A_B5F6_0A83E2C7D915
+
+// Internal Includes
+#include "Timestamp.h"
+
+// Library/third-party includes
+#include <osvr/Util/EigenCoreGeometry.h>
+
+// Standard includes
+#include <array>
+#include <cstddef>
+
+namespace osvr {
+namespace vive {
+
+    /// A pose in the OSVR room space, with the time it was sampled.
+    struct PoseSample {
+        Timestamp time;
+        Eigen::Vector3d position = Eigen::Vector3d::Zero();
+        Eigen::Quaterniond orientation = Eigen::Quaterniond::Identity();
+        /// Meters per second.
+        Eigen::Vector3d velocity = Eigen::Vector3d::Zero();
+        /// Axis times radians per second.
+        Eigen::Vector3d angularVelocity = Eigen::Vector3d::Zero();
+    };
+
+    /// The last CAPACITY poses of a sensor, oldest overwritten first, which
+    /// can be asked for the pose at any time they span: late-latching
+    /// clients want the pose at a particular time rather than the last one
+    /// sent.
+    ///
+    /// Kept in one fixed array, in time order, so adding never allocates
+    /// and finding a time is a binary search. Not thread-safe: one per
+    /// sensor, on the thread that sends poses.
+    class PoseHistory {
+      public:
+        /// A power of two. At the HMD's 1 kHz, a little over 100 ms.
+        static const std::size_t CAPACITY = 128;
+
+        /// Add the newest sample.
+        /// @return false (and the sample is dropped) if it's no later than
+        /// the newest one already held: the history only goes forward.
+        bool add(PoseSample const &sample);
+
+        bool empty() const { return 0 == size_; }
+        std::size_t size() const { return size_; }
+
+        /// The oldest and newest samples. Only when not empty.
+        PoseSample const &oldest() const { return at(0); }
+        PoseSample const &newest() const { return at(size_ - 1); }
+
+        /// The pose at time t: between two samples, interpolated (slerp for
+        /// the orientation, linear for the rest); after the newest,
+        /// extrapolated from its velocities, if t is no more than
+        /// maxExtrapolation seconds after it.
+        /// @return false, leaving out alone, if t is before the oldest
+        /// sample or too far after the newest.
+        bool poseAt(Timestamp const &t, PoseSample &out,
+                    double maxExtrapolation = 0.) const;
+
+        /// Forget every sample, as for a device that's gone, or a change of
+        /// room calibration.
+        void clear() { start_ = size_ = 0; }
+
+      private:
+        /// The i-th sample, oldest first.
+        PoseSample const &at(std::size_t i) const {
+            return samples_[(start_ + i) & (CAPACITY - 1)];
+        }
+        std::array<PoseSample, CAPACITY> samples_;
+        /// Index of the oldest sample in samples_.
+        std::size_t start_ = 0;
+        std::size_t size_ = 0;
+    };
+
+    /// Interpolate between two samples: alpha 0 gives a, 1 gives b.
+    PoseSample interpolate(PoseSample const &a, PoseSample const &b,
+                           double alpha);
+
+    /// Carry a sample forward (or back) in time by its velocities.
+    PoseSample extrapolate(PoseSample const &sample, Timestamp const &t);
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_PoseHistory_h_GUID_6D2B8F40_91E7_4C3A_B5F6_0A83E2C7D915
@@ -27,11 +27,11 @@
 
 #include <cstddef>
 
+#include "Logger.h"
 #include "PropertyTraits.h"
 
 // Standard includes
 #include <assert.h>
-#include <iostream>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -134,18 +134,16 @@ namespace vive {
                 }
 
                 if (ret > buf.size()) {
-                    std::cout
+                    logWarn()
                         << "[getStringProperty] Got an initial return value "
                            "larger than the buffer size: ret = "
-                        << ret << ", buf.size() = " << buf.size() << std::endl;
+                        << ret << ", buf.size() = " << buf.size();
                 }
                 if (vr::TrackedProp_BufferTooSmall == err) {
                     // first buffer was too small, but now we know how big it
                     // should be, per the docs.
-                    /// @todo remove this debug print
-                    std::cout << "[getStringProperty] Initial buffer size: "
-                              << buf.size() << ", return value: " << ret
-                              << std::endl;
+                    logDebug() << "[getStringProperty] Initial buffer size: "
+                               << buf.size() << ", return value: " << ret;
                     buf.resize(ret + 1, '\0');
                     ret = dev->GetStringTrackedDeviceProperty(
                         args..., prop, buf.data(),
@@ -153,10 +151,10 @@ namespace vive {
                 }
 
                 if (ret > buf.size()) {
-                    std::cout
+                    logWarn()
                         << "[getStringProperty] THIS SHOULDN'T HAPPEN: Got a "
                            "return value larger than the buffer size: ret = "
-                        << ret << ", buf.size() = " << buf.size() << std::endl;
+                        << ret << ", buf.size() = " << buf.size();
 
                     return std::make_pair(std::string{}, err);
                 }
@@ -26,6 +26,7 @@
 #define INCLUDED_QuickProcessingDeque_h_GUID_B6819891_863F_4B8A_9024_C0E42E1D21AA
 
 // Internal Includes
+#include "CacheLine.h"
 #include "VerifyLocked.h"
 
 // Library/third-party includes
@@ -33,36 +34,48 @@
 
 // Standard includes
 #include <cstddef>
-#include <deque>
 #include <mutex>
+#include <utility>
 #include <vector>
 
 namespace osvr {
 namespace vive {
 
-    /// A container wrapping a deque (mutex-controlled) and a vector (for main
-    /// thread use only), where work is submitted to the deque, then the main
-    /// thread, upon entering, grabs a number of items from the deque to the
-    /// vector before beginning work on them, allowing shorter lock times.
+    /// A container wrapping a pending vector (mutex-controlled) and a work
+    /// vector (for main thread use only), where work is submitted to the
+    /// pending vector, then the main thread, upon entering, swaps it for the
+    /// (emptied) work vector before beginning work on the items, allowing
+    /// shorter lock times.
+    ///
+    /// The two vectors trade places each time, each keeping its capacity, so
+    /// once they've grown to hold the largest batch seen, neither submitting
+    /// nor grabbing allocates. (The deque this used to be built on allocated
+    /// and freed blocks continually.) reserve() can size them up front.
     template <typename T, typename LockType = std::lock_guard<std::mutex>>
     class QuickProcessingDeque {
       public:
         using value_type = T;
-        using deque_type = std::deque<T>;
         using vector_type = std::vector<T>;
         using lock_type = LockType;
 
+        /// Make room for batches of this many items before any arrive.
+        /// Call before the async thread starts submitting.
+        void reserve(std::size_t n) {
+            pending_.reserve(n);
+            vector_.reserve(n);
+        }
+
         /// Call from the async thread you can't control
         /// Must hold the lock.
         void submitNew(value_type const &v, lock_type &lock) {
             if (verifyLocked<lock_type>(lock)) {
-                deque_.push_back(v);
+                pending_.push_back(v);
             }
         }
 
         void submitNew(value_type &&v, lock_type &lock) {
             if (verifyLocked<lock_type>(lock)) {
-                deque_.emplace_back(std::move(v));
+                pending_.emplace_back(std::move(v));
             }
         }
 
@@ -71,13 +84,9 @@ namespace vive {
         std::size_t grabItems(lock_type &lock) {
             if (verifyLocked<lock_type>(lock)) {
                 clearWorkItems();
-                /// Copy a fixed number of reports that have been queued up.
-                auto numItems = deque_.size();
-                for (std::size_t i = 0; i < numItems; ++i) {
-                    vector_.push_back(deque_.front());
-                    deque_.pop_front();
-                }
-                return numItems;
+                /// Take everything that's been queued up.
+                vector_.swap(pending_);
+                return vector_.size();
             }
             return 0;
         }
@@ -92,11 +101,13 @@ namespace vive {
         void clearWorkItems() { vector_.clear(); }
 
       private:
-        /// for mutex-controlled use.
-        deque_type deque_;
+        /// for mutex-controlled use. A cache line apart from vector_, so
+        /// submitting doesn't keep taking the line away from the main thread
+        /// while it works through the last batch.
+        alignas(CACHE_LINE_SIZE) vector_type pending_;
 
         /// for temporary use by the main thread.
-        vector_type vector_;
+        alignas(CACHE_LINE_SIZE) vector_type vector_;
     };
 
 } // namespace vive
@@ -0,0 +1,137 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RcuPointer_h_GUID_9D1E6A34_2B7F_4E85_A0C3_5F8B2D6E1A97
+#define INCLUDED_RcuPointer_h_GUID_9D1E6A34_2B7F_4E85_A0C3_5F8B2D6E1A97
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace osvr {
+namespace vive {
+
+    /// A pointer to an immutable snapshot of some data, read-copy-update
+    /// style: readers on any thread get at the current snapshot without a
+    /// lock, while a writer publishes a replacement with an atomic swap.
+    ///
+    /// Replaced snapshots are retired rather than freed, and only reclaimed
+    /// once the writer observes no readers in flight - so a reader never has
+    /// a snapshot pulled out from under it, and never waits on the writer.
+    ///
+    /// Reading is thread-safe. Writing (publish() and reclaim()) must be
+    /// serialized externally.
+    template <typename T> class RcuPointer {
+      public:
+        using value_type = T;
+
+        RcuPointer() : current_(new T) {}
+        explicit RcuPointer(std::unique_ptr<T const> &&initial)
+            : current_(initial.release()) {}
+        ~RcuPointer() { delete current_.load(); }
+
+        RcuPointer(RcuPointer const &) = delete;
+        RcuPointer &operator=(RcuPointer const &) = delete;
+
+        /// Keeps a snapshot alive for as long as it exists. Hold it only for
+        /// the duration of a lookup.
+        class ReadGuard {
+          public:
+            ReadGuard(ReadGuard &&other)
+                : readers_(other.readers_), snapshot_(other.snapshot_) {
+                other.readers_ = nullptr;
+            }
+            ~ReadGuard() {
+                if (readers_) {
+                    readers_->fetch_sub(1, std::memory_order_release);
+                }
+            }
+            ReadGuard(ReadGuard const &) = delete;
+            ReadGuard &operator=(ReadGuard const &) = delete;
+
+            T const &operator*() const { return *snapshot_; }
+            T const *operator->() const { return snapshot_; }
+
+          private:
+            friend class RcuPointer;
+            ReadGuard(std::atomic<std::size_t> &readers,
+                      std::atomic<T const *> const &current)
+                : readers_(&readers) {
+                /// Must announce ourselves before loading the pointer, so a
+                /// writer that sees no readers also knows nobody can still
+                /// be holding what it just retired.
+                readers_->fetch_add(1, std::memory_order_seq_cst);
+                snapshot_ = current.load(std::memory_order_seq_cst);
+            }
+            std::atomic<std::size_t> *readers_;
+            T const *snapshot_ = nullptr;
+        };
+
+        /// Get the current snapshot. Safe from any thread.
+        ReadGuard read() const { return ReadGuard(readers_, current_); }
+
+        /// Replace the current snapshot, retiring the old one.
+        void publish(std::unique_ptr<T const> &&next) {
+            std::unique_ptr<T const> old(
+                current_.exchange(next.release(), std::memory_order_seq_cst));
+            retired_.emplace_back(std::move(old));
+            reclaim();
+        }
+
+        /// Convenience: publish a copy of the given value.
+        void publish(T const &next) {
+            publish(std::unique_ptr<T const>(new T(next)));
+        }
+
+        /// Free retired snapshots if no reader could still be using them.
+        /// Called by publish(), but worth calling now and then from the
+        /// writer so retired snapshots don't hang around between publishes.
+        void reclaim() {
+            if (retired_.empty()) {
+                return;
+            }
+            if (0 == readers_.load(std::memory_order_seq_cst)) {
+                retired_.clear();
+            }
+        }
+
+      private:
+        std::atomic<T const *> current_;
+        mutable std::atomic<std::size_t> readers_{0};
+        std::vector<std::unique_ptr<T const>> retired_;
+    };
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_RcuPointer_h_GUID_9D1E6A34_2B7F_4E85_A0C3_5F8B2D6E1A97
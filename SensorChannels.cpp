@@ -0,0 +1,157 @@
+/** @file
+    @brief Implementation
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "SensorChannels.h"
+
+// Library/third-party includes
+#include <json/reader.h>
+#include <json/value.h>
+#include <json/writer.h>
+
+// Standard includes
+#include <algorithm>
+#include <stdexcept>
+
+namespace osvr {
+namespace vive {
+
+    /// The sensors that the static com_osvr_Vive.json already describes.
+    static const std::uint32_t NUM_DESCRIBED_SENSORS = 3;
+
+    bool SensorChannelTable::activate(std::uint32_t sensor, DeviceRole role) {
+        if (!(sensor < MAX_SENSORS)) {
+            return false;
+        }
+        auto &entry = sensors_[sensor];
+        entry.active = true;
+        entry.role = role;
+        entry.firstButton = firstButtonForSensor(sensor);
+        entry.firstAnalog = firstAnalogForSensor(sensor);
+        return true;
+    }
+
+    bool SensorChannelTable::deactivate(std::uint32_t sensor) {
+        if (!isActive(sensor)) {
+            return false;
+        }
+        sensors_[sensor] = SensorChannels{};
+        return true;
+    }
+
+    SensorChannels const &SensorChannelTable::get(std::uint32_t sensor) const {
+        return sensors_.at(sensor);
+    }
+
+    std::uint32_t SensorChannelTable::highestActive() const {
+        for (std::uint32_t i = MAX_SENSORS; i > 0; --i) {
+            if (sensors_[i - 1].active) {
+                return i - 1;
+            }
+        }
+        return 0;
+    }
+
+    OSVR_ChannelCount SensorChannelTable::trackerCount() const {
+        return std::max(highestActive() + 1, NUM_DESCRIBED_SENSORS);
+    }
+
+    OSVR_ChannelCount SensorChannelTable::buttonCount() const {
+        return firstButtonForSensor(trackerCount());
+    }
+
+    OSVR_ChannelCount SensorChannelTable::analogCount() const {
+        return firstAnalogForSensor(trackerCount());
+    }
+
+    static inline std::string channelPath(const char *iface,
+                                          OSVR_ChannelCount channel) {
+        return std::string(iface) + "/" + std::to_string(channel);
+    }
+
+    /// Semantic entry for one of the additional controller-shaped sensors,
+    /// laid out just like the "left" and "right" ones in the base descriptor.
+    static inline Json::Value describeExtraSensor(std::uint32_t sensor,
+                                                  SensorChannels const &ch) {
+        Json::Value ret(Json::objectValue);
+        ret["$target"] = channelPath("tracker", sensor);
+        if (ch.role != DeviceRole::Controller) {
+            return ret;
+        }
+        auto button = [&](OSVR_ChannelCount offset) {
+            return channelPath("button", ch.firstButton + offset);
+        };
+        auto analog = [&](OSVR_ChannelCount offset) {
+            return channelPath("analog", ch.firstAnalog + offset);
+        };
+        ret["system"] = button(SYSTEM_BUTTON_OFFSET);
+        ret["menu"] = button(MENU_BUTTON_OFFSET);
+        ret["grip"] = button(GRIP_BUTTON_OFFSET);
+        auto &trackpad = ret["trackpad"];
+        trackpad["x"] = analog(TRACKPAD_X_ANALOG_OFFSET);
+        trackpad["y"] = analog(TRACKPAD_Y_ANALOG_OFFSET);
+        trackpad["touch"] = button(TRACKPAD_TOUCH_BUTTON_OFFSET);
+        trackpad["button"] = button(TRACKPAD_CLICK_BUTTON_OFFSET);
+        auto &trigger = ret["trigger"];
+        trigger["$target"] = analog(TRIGGER_ANALOG_OFFSET);
+        trigger["button"] = button(TRIGGER_BUTTON_OFFSET);
+        return ret;
+    }
+
+    std::string
+    SensorChannelTable::generateDescriptor(const char *baseJson,
+                                           bool automaticAliases) const {
+        Json::Value root;
+        Json::Reader reader;
+        if (!reader.parse(baseJson, root)) {
+            throw std::runtime_error(
+                "Could not parse base device descriptor: " +
+                reader.getFormattedErrorMessages());
+        }
+        auto &ifaces = root["interfaces"];
+        ifaces["tracker"]["count"] = trackerCount();
+        ifaces["button"]["count"] = buttonCount();
+        ifaces["analog"]["count"] = analogCount();
+        if (!automaticAliases) {
+            root.removeMember("automaticAliases");
+        }
+
+        auto &semantic = root["semantic"];
+        for (std::uint32_t i = NUM_DESCRIBED_SENSORS; i < MAX_SENSORS; ++i) {
+            auto const &ch = sensors_[i];
+            if (!ch.active) {
+                continue;
+            }
+            /// Extra controllers go next to left and right, so the
+            /// "/controller" wildcard alias picks them up too.
+            auto &group = semantic[ch.role == DeviceRole::Controller
+                                       ? "controller"
+                                       : "tracker"];
+            group[std::to_string(i)] = describeExtraSensor(i, ch);
+        }
+        return Json::FastWriter().write(root);
+    }
+
+} // namespace vive
+} // namespace osvr
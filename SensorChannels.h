@@ -0,0 +1,172 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SensorChannels_h_GUID_4A0C2E51_93B7_4F0E_A1D2_6E5B8C7D9F31
+#define INCLUDED_SensorChannels_h_GUID_4A0C2E51_93B7_4F0E_A1D2_6E5B8C7D9F31
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+#include <osvr/Util/ClientReportTypesC.h>
+
+// Standard includes
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace osvr {
+namespace vive {
+
+    /// Maximum number of tracked devices (and thus tracker sensors) we will
+    /// route events for. SteamVR itself tops out at 16, this leaves headroom.
+    static const std::uint32_t MAX_SENSORS = 32;
+
+    /// Most HMDs driven at once. Each gets a device group: an OSVR device of
+    /// its own ("Vive", then "Vive2" and so on), with a namespace of
+    /// MAX_SENSORS sensors for it and the devices that go with it.
+    static const std::uint32_t MAX_HMDS = 4;
+
+    /// The driver's device IDs cover every group's sensors: the ID of a
+    /// group's sensor is group * MAX_SENSORS + sensor, so the first group's
+    /// sensor IDs and device IDs are one and the same.
+    static const std::uint32_t MAX_DEVICE_IDS = MAX_HMDS * MAX_SENSORS;
+
+    inline std::uint32_t groupForDeviceId(std::uint32_t id) {
+        return id / MAX_SENSORS;
+    }
+
+    inline std::uint32_t sensorForDeviceId(std::uint32_t id) {
+        return id % MAX_SENSORS;
+    }
+
+    inline std::uint32_t deviceIdFor(std::uint32_t group,
+                                     std::uint32_t sensor) {
+        return group * MAX_SENSORS + sensor;
+    }
+
+    /// The HMD is always sensor 0, with a small channel block of its own.
+    static const std::uint32_t HMD_SENSOR = 0;
+    static const OSVR_ChannelCount HMD_NUM_BUTTONS = 2;
+    static const OSVR_ChannelCount HMD_NUM_ANALOGS = 1;
+
+    /// Every other sensor gets a controller-sized block of channels, so the
+    /// first two controllers land exactly where com_osvr_Vive.json expects.
+    static const OSVR_ChannelCount CONTROLLER_NUM_BUTTONS = 6;
+    static const OSVR_ChannelCount CONTROLLER_NUM_ANALOGS = 3;
+
+    /// Offsets from the first button ID for the HMD.
+    static const OSVR_ChannelCount HMD_SYSTEM_BUTTON_OFFSET = 0;
+    static const OSVR_ChannelCount PROX_SENSOR_BUTTON_OFFSET = 1;
+    /// Analog sensor for the IPD
+    static const OSVR_ChannelCount IPD_ANALOG = 0;
+
+    /// Offsets from the first button ID for a controller that a button is
+    /// reported.
+    static const OSVR_ChannelCount SYSTEM_BUTTON_OFFSET = 0;
+    static const OSVR_ChannelCount MENU_BUTTON_OFFSET = 1;
+    static const OSVR_ChannelCount GRIP_BUTTON_OFFSET = 2;
+    static const OSVR_ChannelCount TRACKPAD_TOUCH_BUTTON_OFFSET = 3;
+    static const OSVR_ChannelCount TRACKPAD_CLICK_BUTTON_OFFSET = 4;
+    static const OSVR_ChannelCount TRIGGER_BUTTON_OFFSET = 5;
+
+    /// Offsets from the first analog ID for a controller that an analog is
+    /// reported.
+    static const OSVR_ChannelCount TRACKPAD_X_ANALOG_OFFSET = 0;
+    static const OSVR_ChannelCount TRACKPAD_Y_ANALOG_OFFSET = 1;
+    static const OSVR_ChannelCount TRIGGER_ANALOG_OFFSET = 2;
+
+    /// What sort of device owns a sensor - determines how its events are
+    /// mapped and how it shows up in the device descriptor.
+    enum class DeviceRole { HMD, Controller, Other };
+
+    struct SensorChannels {
+        bool active = false;
+        DeviceRole role = DeviceRole::Other;
+        OSVR_ChannelCount firstButton = 0;
+        OSVR_ChannelCount firstAnalog = 0;
+    };
+
+    inline OSVR_ChannelCount firstButtonForSensor(std::uint32_t sensor) {
+        return sensor == HMD_SENSOR
+                   ? 0
+                   : HMD_NUM_BUTTONS + (sensor - 1) * CONTROLLER_NUM_BUTTONS;
+    }
+
+    inline OSVR_ChannelCount firstAnalogForSensor(std::uint32_t sensor) {
+        return sensor == HMD_SENSOR
+                   ? 0
+                   : HMD_NUM_ANALOGS + (sensor - 1) * CONTROLLER_NUM_ANALOGS;
+    }
+
+    /// Total number of channels to configure the OSVR device interfaces with:
+    /// they can't be grown after the device token is initialized, so we
+    /// configure for the maximum and just advertise what's in use.
+    static const OSVR_ChannelCount BUTTON_CAPACITY =
+        HMD_NUM_BUTTONS + (MAX_SENSORS - 1) * CONTROLLER_NUM_BUTTONS;
+    static const OSVR_ChannelCount ANALOG_CAPACITY =
+        HMD_NUM_ANALOGS + (MAX_SENSORS - 1) * CONTROLLER_NUM_ANALOGS;
+
+    /// Tracks which sensors are in use and the channel blocks assigned to
+    /// them, and produces a device descriptor that matches.
+    ///
+    /// Not thread-safe on its own.
+    class SensorChannelTable {
+      public:
+        /// @return false if the sensor is out of range.
+        bool activate(std::uint32_t sensor, DeviceRole role);
+
+        /// @return false if the sensor wasn't active.
+        bool deactivate(std::uint32_t sensor);
+
+        SensorChannels const &get(std::uint32_t sensor) const;
+
+        bool isActive(std::uint32_t sensor) const {
+            return sensor < MAX_SENSORS && sensors_[sensor].active;
+        }
+
+        /// Counts to advertise: at least those in the static descriptor, more
+        /// if higher sensors are active.
+        OSVR_ChannelCount trackerCount() const;
+        OSVR_ChannelCount buttonCount() const;
+        OSVR_ChannelCount analogCount() const;
+
+        /// Regenerate the JSON device descriptor from the base one, adjusting
+        /// interface counts and adding semantic entries for sensors beyond
+        /// the HMD and the two controllers named in the base descriptor.
+        /// @param automaticAliases false to leave out the base descriptor's
+        /// automatic aliases (/me/head and so on), which only one device can
+        /// have.
+        std::string generateDescriptor(const char *baseJson,
+                                       bool automaticAliases = true) const;
+
+      private:
+        std::uint32_t highestActive() const;
+        std::array<SensorChannels, MAX_SENSORS> sensors_;
+    };
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_SensorChannels_h_GUID_4A0C2E51_93B7_4F0E_A1D2_6E5B8C7D9F31
@@ -0,0 +1,159 @@
+/** @file
+    @brief Implementation
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "SensorIdMap.h"
+
+// Library/third-party includes
+#include <json/reader.h>
+#include <json/value.h>
+#include <json/writer.h>
+
+// Standard includes
+#include <cstdio>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace osvr {
+namespace vive {
+    static const auto JSON_ID = "osvr_vive_sensor_ids";
+
+    /// Move the temporary file over the destination in one step, so readers
+    /// (and a crash mid-write) only ever see a complete file.
+    static inline bool replaceFile(std::string const &tmp,
+                                   std::string const &dest) {
+#ifdef _WIN32
+        return 0 != MoveFileExA(tmp.c_str(), dest.c_str(),
+                                MOVEFILE_REPLACE_EXISTING |
+                                    MOVEFILE_WRITE_THROUGH);
+#else
+        return 0 == std::rename(tmp.c_str(), dest.c_str());
+#endif
+    }
+
+    bool SensorIdMap::load(std::string const &fn) {
+        bySerial_.clear();
+        byId_.clear();
+        dirty_ = false;
+        message_.clear();
+
+        std::ifstream is(fn);
+        if (!is) {
+            message_ = "No sensor ID map found at " + fn;
+            return false;
+        }
+        Json::Value root;
+        Json::Reader reader;
+        if (!reader.parse(is, root)) {
+            message_ = "Could not parse sensor ID map at " + fn + ": " +
+                       reader.getFormattedErrorMessages();
+            return false;
+        }
+        if (root["jsonid"] != JSON_ID || !root["sensors"].isObject()) {
+            message_ = "Sensor ID map at " + fn +
+                       " did not match the expected format";
+            return false;
+        }
+        auto const &sensors = root["sensors"];
+        for (auto const &serial : sensors.getMemberNames()) {
+            auto const &id = sensors[serial];
+            if (!id.isUInt()) {
+                continue;
+            }
+            assign(serial, id.asUInt());
+        }
+        dirty_ = false;
+        return true;
+    }
+
+    bool SensorIdMap::save(std::string const &fn) {
+        Json::Value root(Json::objectValue);
+        root["jsonid"] = JSON_ID;
+        auto &sensors = root["sensors"];
+        sensors = Json::Value(Json::objectValue);
+        for (auto const &entry : bySerial_) {
+            sensors[entry.first] = entry.second;
+        }
+
+        auto tmp = fn + ".tmp";
+        {
+            std::ofstream os(tmp, std::ios::out | std::ios::trunc);
+            if (!os) {
+                message_ = "Could not open " + tmp + " for writing";
+                return false;
+            }
+            os << Json::StyledWriter().write(root);
+            if (!os.flush()) {
+                message_ = "Could not write to " + tmp;
+                return false;
+            }
+        }
+        if (!replaceFile(tmp, fn)) {
+            std::remove(tmp.c_str());
+            message_ = "Could not replace " + fn;
+            return false;
+        }
+        dirty_ = false;
+        return true;
+    }
+
+    std::pair<bool, std::uint32_t>
+    SensorIdMap::lookup(std::string const &serial) const {
+        auto it = bySerial_.find(serial);
+        if (it == end(bySerial_)) {
+            return std::make_pair(false, 0);
+        }
+        return std::make_pair(true, it->second);
+    }
+
+    bool SensorIdMap::claimedByOther(std::uint32_t id,
+                                     std::string const &serial) const {
+        auto it = byId_.find(id);
+        return it != end(byId_) && it->second != serial;
+    }
+
+    void SensorIdMap::assign(std::string const &serial, std::uint32_t id) {
+        auto existing = lookup(serial);
+        if (existing.first && existing.second == id) {
+            return;
+        }
+        if (existing.first) {
+            byId_.erase(existing.second);
+        }
+        auto displaced = byId_.find(id);
+        if (displaced != end(byId_)) {
+            bySerial_.erase(displaced->second);
+        }
+        bySerial_[serial] = id;
+        byId_[id] = serial;
+        dirty_ = true;
+    }
+
+} // namespace vive
+} // namespace osvr
@@ -0,0 +1,91 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SensorIdMap_h_GUID_7E3B91C2_5D04_4C6A_B8F1_2A9D0E6C4B57
+#define INCLUDED_SensorIdMap_h_GUID_7E3B91C2_5D04_4C6A_B8F1_2A9D0E6C4B57
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace osvr {
+namespace vive {
+
+    /// A small table pinning device serial numbers to the sensor IDs they
+    /// were last assigned, so those assignments survive a server restart.
+    ///
+    /// Only consulted when activating devices, never on the report path. Not
+    /// thread-safe on its own.
+    class SensorIdMap {
+      public:
+        /// Replace the contents with those of the given file.
+        /// @return false if the file was missing or unusable (in which case
+        /// the map is left empty, and getMessage() says why)
+        bool load(std::string const &fn);
+
+        /// Write the contents out to the given file, replacing it atomically.
+        /// @return false on failure, with details in getMessage().
+        bool save(std::string const &fn);
+
+        /// @return a (found, sensor ID) pair for a serial number.
+        std::pair<bool, std::uint32_t> lookup(std::string const &serial) const;
+
+        /// @return true if the given ID is pinned to a serial number other
+        /// than the one passed.
+        bool claimedByOther(std::uint32_t id, std::string const &serial) const;
+
+        /// Pin a serial number to an ID, displacing any other serial number
+        /// previously pinned there.
+        void assign(std::string const &serial, std::uint32_t id);
+
+        /// Has the map changed since it was last loaded or saved?
+        bool dirty() const { return dirty_; }
+
+        /// Override the dirty flag: for when a copy of the map gets saved
+        /// instead of this one.
+        void setDirty(bool dirty) { dirty_ = dirty; }
+
+        std::size_t size() const { return bySerial_.size(); }
+
+        std::string const &getMessage() const { return message_; }
+
+      private:
+        std::map<std::string, std::uint32_t> bySerial_;
+        std::map<std::uint32_t, std::string> byId_;
+        bool dirty_ = false;
+        std::string message_;
+    };
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_SensorIdMap_h_GUID_7E3B91C2_5D04_4C6A_B8F1_2A9D0E6C4B57
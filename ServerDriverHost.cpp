@@ -24,25 +24,18 @@
 
 // Internal Includes
 #include <ServerDriverHost.h>
+#include "Logger.h"
 
 // Library/third-party includes
 // - none
 
 // Standard includes
-#include <iostream>
+// - none
 
 using namespace vr;
 
-#ifdef DISABLE_LOG_EVENTS
-#define LOG_EVENTS(X)                                                          \
-    do {                                                                       \
-    } while (0)
-#else
-#define LOG_EVENTS(X)                                                          \
-    do {                                                                       \
-        std::cout << X << std::endl;                                           \
-    } while (0)
-#endif
+/// Trace level: some of these, like IsExiting(), come every frame.
+#define LOG_EVENTS(X) OSVR_VIVE_LOG_TRACE(X)
 
 vr::ServerDriverHost::ServerDriverHost() {}
 
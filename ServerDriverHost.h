@@ -32,6 +32,7 @@
 #include <openvr_driver.h>
 
 // Standard includes
+#include <atomic>
 #include <functional>
 
 // refer to IServerDriverHost for details on each function
@@ -93,7 +94,8 @@ class ServerDriverHost : public vr::IServerDriverHost {
     IVRSettings *vrSettings = nullptr;
 
   private:
-    bool isExiting_ = false;
+    /// Polled from the driver's threads.
+    std::atomic<bool> isExiting_{false};
 };
 
 } // namespace vr
@@ -0,0 +1,232 @@
+/** @file
+    @brief Tool measuring how long poses take to get through shared memory,
+    from SharedPoseSink::publish() to a SharedPoseReader seeing them.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "Logger.h"
+#include "SharedPoseReader.h"
+#include "SharedPoseSink.h"
+#include "Timestamp.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace osvr::vive;
+namespace sp = osvr::vive::shared_pose;
+
+static const auto PREFIX = "[ViveSharedPoseLatency] ";
+
+struct Options {
+    /// If not empty, measure the plugin's segment of this name, rather than
+    /// one of our own.
+    std::string attach;
+    /// Poses published per second, per sensor, when using our own segment.
+    double rate = 1000.;
+    std::uint32_t sensors = 3;
+    double seconds = 5.;
+};
+
+static void usage(const char *argv0) {
+    std::cerr << "Usage: " << argv0
+              << " [--rate <Hz>] [--sensors <n>] [--seconds <s>]\n"
+                 "       "
+              << argv0
+              << " --attach <name> [--seconds <s>]\n\n"
+                 "Without --attach, publishes poses at the given rate (default "
+                 "1000 Hz) for each\n"
+                 "of the given number of sensors (default 3) to a shared "
+                 "memory segment of its\n"
+                 "own while a second thread reads them, and reports how long "
+                 "each took to be seen.\n\n"
+                 "With --attach, reads the segment the plugin publishes to "
+                 "(its sharedPoseMemory\n"
+                 "option) and reports how long poses took to be seen after "
+                 "being published, and\n"
+                 "how old they were by then.\n"
+              << std::endl;
+}
+
+static bool parseArgs(int argc, char *argv[], Options &opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool haveValue = i + 1 < argc;
+        if (arg == "--attach" && haveValue) {
+            opts.attach = argv[++i];
+        } else if (arg == "--rate" && haveValue) {
+            opts.rate = std::atof(argv[++i]);
+        } else if (arg == "--sensors" && haveValue) {
+            opts.sensors = static_cast<std::uint32_t>(std::atol(argv[++i]));
+        } else if (arg == "--seconds" && haveValue) {
+            opts.seconds = std::atof(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    return opts.rate > 0 && opts.seconds > 0 && opts.sensors > 0 &&
+           opts.sensors <= sp::SENSORS_PER_DEVICE;
+}
+
+/// Latencies in microseconds, summarized as percentiles.
+static void report(const char *what, std::vector<std::int64_t> &us) {
+    if (us.empty()) {
+        std::cout << PREFIX << what << ": no samples" << std::endl;
+        return;
+    }
+    std::sort(us.begin(), us.end());
+    auto at = [&](double p) {
+        auto i =
+            static_cast<std::size_t>(p * static_cast<double>(us.size() - 1));
+        return us[i];
+    };
+    std::cout << PREFIX << what << " (us, " << us.size()
+              << " samples): min " << us.front() << ", p50 " << at(0.5)
+              << ", p99 " << at(0.99) << ", p99.9 " << at(0.999) << ", max "
+              << us.back() << std::endl;
+}
+
+/// Poll the reader until the deadline, noting each pose the first time it's
+/// seen. Returns the number of poses seen.
+static std::size_t pollPoses(SharedPoseReader const &reader,
+                             std::uint32_t devices, std::uint32_t sensors,
+                             Timestamp deadline,
+                             std::vector<std::int64_t> &publishLatency,
+                             std::vector<std::int64_t> &sampleAge) {
+    std::vector<std::uint32_t> lastSequence(sp::SLOT_COUNT, 0);
+    std::size_t seen = 0;
+    sp::PoseData data;
+    while (Timestamp::now().microseconds() < deadline.microseconds()) {
+        for (std::uint32_t device = 0; device < devices; ++device) {
+            for (std::uint32_t sensor = 0; sensor < sensors; ++sensor) {
+                std::uint32_t sequence = 0;
+                auto &last =
+                    lastSequence[device * sp::SENSORS_PER_DEVICE + sensor];
+                if (!reader.read(device, sensor, data, &sequence) ||
+                    sequence == last) {
+                    continue;
+                }
+                auto now = Timestamp::now().microseconds();
+                last = sequence;
+                seen++;
+                publishLatency.push_back(now - data.publishTimeUs);
+                sampleAge.push_back(now - data.sampleTimeUs);
+            }
+        }
+    }
+    return seen;
+}
+
+static int attach(Options const &opts) {
+    SharedPoseReader reader;
+    if (!reader.open(opts.attach)) {
+        std::cerr << PREFIX << reader.getError() << std::endl;
+        return 1;
+    }
+    if (!reader.isWriterActive()) {
+        std::cerr << PREFIX << "Warning: the plugin no longer has "
+                  << opts.attach << " open." << std::endl;
+    }
+    std::vector<std::int64_t> publishLatency;
+    std::vector<std::int64_t> sampleAge;
+    auto seen = pollPoses(reader, sp::DEVICE_COUNT, sp::SENSORS_PER_DEVICE,
+                          Timestamp::now().offsetBy(opts.seconds),
+                          publishLatency, sampleAge);
+    std::cout << PREFIX << seen << " poses seen in " << opts.seconds
+              << " s" << std::endl;
+    report("Publish to read", publishLatency);
+    report("Sample to read", sampleAge);
+    return 0;
+}
+
+static int selfTest(Options const &opts) {
+    auto name = "/osvr-vive-latency-" + std::to_string(getpid());
+    SharedPoseSink sink;
+    if (!sink.open(name)) {
+        return 1;
+    }
+    SharedPoseReader reader;
+    if (!reader.open(name)) {
+        std::cerr << PREFIX << reader.getError() << std::endl;
+        return 1;
+    }
+
+    auto start = Timestamp::now();
+    auto deadline = start.offsetBy(opts.seconds);
+    std::vector<std::int64_t> publishLatency;
+    std::vector<std::int64_t> sampleAge;
+    std::size_t seen = 0;
+    std::thread readerThread([&] {
+        seen = pollPoses(reader, 1, opts.sensors, deadline, publishLatency,
+                         sampleAge);
+    });
+
+    std::size_t published = 0;
+    auto period = std::chrono::duration<double>(1. / opts.rate);
+    auto next = std::chrono::steady_clock::now();
+    sp::PoseData data = sp::PoseData();
+    data.flags = sp::POSE_VALID | sp::DEVICE_CONNECTED;
+    data.orientation[0] = 1;
+    while (Timestamp::now().microseconds() < deadline.microseconds()) {
+        for (std::uint32_t sensor = 0; sensor < opts.sensors; ++sensor) {
+            data.sensor = sensor;
+            data.position[0] = static_cast<double>(published);
+            data.sampleTimeUs = Timestamp::now().microseconds();
+            data.publishTimeUs = Timestamp::now().microseconds();
+            sink.publish(data);
+            published++;
+        }
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            period);
+        std::this_thread::sleep_until(next);
+    }
+    readerThread.join();
+
+    std::cout << PREFIX << published << " poses published, " << seen
+              << " seen (a pose replaced before being read is never seen)"
+              << std::endl;
+    report("Publish to read", publishLatency);
+    return seen > 0 ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        usage(argv[0]);
+        return 1;
+    }
+    int ret = opts.attach.empty() ? selfTest(opts) : attach(opts);
+    Logger::instance().flush();
+    return ret;
+}
@@ -0,0 +1,124 @@
+/** @file
+    @brief Header describing the shared-memory segment poses are published
+    in, shared by the plugin and the readers of the segment. Nothing from
+    OSVR or OpenVR here, so readers need neither.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SharedPoseLayout_h_GUID_7D15A3C2_94E8_4B0F_A6C1_3E82F5D9B704
+#define INCLUDED_SharedPoseLayout_h_GUID_7D15A3C2_94E8_4B0F_A6C1_3E82F5D9B704
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <atomic>
+#include <cstdint>
+
+namespace osvr {
+namespace vive {
+    namespace shared_pose {
+
+        /// Written last when the segment is set up, so a reader that sees it
+        /// sees the rest of the header too. "VIVP", read as little-endian.
+        static const std::uint32_t MAGIC = 0x50564956;
+        /// Bumped whenever the layout changes.
+        static const std::uint32_t VERSION = 2;
+        /// Slots for each of the plugin's devices ("Vive", "Vive2", ...),
+        /// one per sensor.
+        static const std::uint32_t SENSORS_PER_DEVICE = 32;
+        static const std::uint32_t DEVICE_COUNT = 4;
+        /// A device's sensor's slot is device * SENSORS_PER_DEVICE + sensor.
+        static const std::uint32_t SLOT_COUNT =
+            DEVICE_COUNT * SENSORS_PER_DEVICE;
+
+        /// Bit of PoseData::flags: the driver said the pose was valid.
+        static const std::uint32_t POSE_VALID = 1u << 0;
+        /// Bit of PoseData::flags: the driver said the device was connected.
+        static const std::uint32_t DEVICE_CONNECTED = 1u << 1;
+
+        /// One sensor's latest pose, in the same room space, and with the
+        /// same timestamp, as the plugin reports to OSVR.
+        struct PoseData {
+            std::uint32_t sensor;
+            std::uint32_t flags;
+            /// When the pose was sampled, and when it was published, in
+            /// microseconds on the monotonic clock (CLOCK_MONOTONIC, which
+            /// std::chrono::steady_clock reads on Linux).
+            std::int64_t sampleTimeUs;
+            std::int64_t publishTimeUs;
+            /// sampleTimeUs on the OSVR clock, as in the OSVR report.
+            std::int64_t osvrSeconds;
+            std::int32_t osvrMicroseconds;
+            /// Which of the plugin's devices the sensor belongs to: 0 for
+            /// "Vive", 1 for "Vive2", and so on.
+            std::uint32_t device;
+            /// Meters.
+            double position[3];
+            /// Unit quaternion: w, x, y, z.
+            double orientation[4];
+            /// Meters per second.
+            double velocity[3];
+            /// Radians per second about each axis.
+            double angularVelocity[3];
+        };
+
+        /// A seqlock-protected PoseData. The writer makes sequence odd while
+        /// it changes the data and even again after; readers copy the data
+        /// and retry if sequence was odd or changed meanwhile. 0 until the
+        /// first pose is published.
+        struct alignas(64) Slot {
+            std::atomic<std::uint32_t> sequence;
+            std::uint32_t reserved;
+            PoseData data;
+        };
+
+        struct alignas(64) Header {
+            std::atomic<std::uint32_t> magic;
+            std::uint32_t version;
+            std::uint32_t slotCount;
+            std::uint32_t slotSize;
+            /// Incremented each time a writer sets up the segment.
+            std::atomic<std::uint32_t> generation;
+            /// Non-zero while the writer has the segment open. Once it's
+            /// cleared, the segment is gone from the namespace, so readers
+            /// should re-open it to follow a new writer.
+            std::atomic<std::uint32_t> writerActive;
+        };
+
+        struct Segment {
+            Header header;
+            Slot slots[SLOT_COUNT];
+        };
+
+        static_assert(ATOMIC_INT_LOCK_FREE == 2,
+                      "Sharing atomics between processes needs them to be "
+                      "lock-free.");
+
+    } // namespace shared_pose
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_SharedPoseLayout_h_GUID_7D15A3C2_94E8_4B0F_A6C1_3E82F5D9B704
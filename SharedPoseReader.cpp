@@ -0,0 +1,134 @@
+/** @file
+    @brief Implementation
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "SharedPoseReader.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace osvr {
+namespace vive {
+    using namespace shared_pose;
+
+    /// A read only fails to get a consistent copy if the writer changed the
+    /// slot every time, which it can't keep up for long: poses come in at
+    /// most every millisecond or so.
+    static const int MAX_READ_ATTEMPTS = 1000;
+
+    SharedPoseReader::~SharedPoseReader() { close(); }
+
+    bool SharedPoseReader::open(std::string const &name) {
+        close();
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            error_ = "Could not open " + name + ": " + std::strerror(errno);
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 ||
+            static_cast<std::size_t>(st.st_size) < sizeof(Segment)) {
+            ::close(fd);
+            error_ = name + " is too small to hold poses (not set up yet?)";
+            return false;
+        }
+        auto mem = mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (MAP_FAILED == mem) {
+            error_ = "Could not map " + name + ": " + std::strerror(errno);
+            return false;
+        }
+        auto segment = static_cast<Segment const *>(mem);
+        auto const &header = segment->header;
+        if (header.magic.load(std::memory_order_acquire) != MAGIC) {
+            error_ = name + " isn't a pose segment (or isn't set up yet)";
+        } else if (header.version != VERSION ||
+                   header.slotCount != SLOT_COUNT ||
+                   header.slotSize != sizeof(Slot)) {
+            error_ = name + " has a layout from a different version";
+        } else {
+            segment_ = segment;
+            error_.clear();
+            return true;
+        }
+        munmap(mem, sizeof(Segment));
+        return false;
+    }
+
+    void SharedPoseReader::close() {
+        if (segment_) {
+            munmap(const_cast<Segment *>(segment_), sizeof(Segment));
+            segment_ = nullptr;
+        }
+    }
+
+    bool SharedPoseReader::isWriterActive() const {
+        return segment_ &&
+               segment_->header.writerActive.load(std::memory_order_acquire);
+    }
+
+    std::uint32_t SharedPoseReader::getGeneration() const {
+        return segment_
+                   ? segment_->header.generation.load(std::memory_order_acquire)
+                   : 0;
+    }
+
+    bool SharedPoseReader::read(std::uint32_t device, std::uint32_t sensor,
+                                PoseData &out, std::uint32_t *sequence) const {
+        if (!segment_ || !(device < DEVICE_COUNT) ||
+            !(sensor < SENSORS_PER_DEVICE)) {
+            return false;
+        }
+        auto const &slot =
+            segment_->slots[device * SENSORS_PER_DEVICE + sensor];
+        for (int i = 0; i < MAX_READ_ATTEMPTS; ++i) {
+            auto before = slot.sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                /// Mid-write.
+                continue;
+            }
+            std::memcpy(&out, &slot.data, sizeof(out));
+            /// Keeps the data reads before the second sequence read.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            auto after = slot.sequence.load(std::memory_order_relaxed);
+            if (before == after) {
+                if (sequence) {
+                    *sequence = before;
+                }
+                return before != 0;
+            }
+        }
+        return false;
+    }
+
+} // namespace vive
+} // namespace osvr
@@ -0,0 +1,97 @@
+/** @file
+    @brief Header for reading the poses the plugin publishes to shared
+    memory. Part of a small standalone library, for applications that want
+    the poses without OSVR.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SharedPoseReader_h_GUID_3A6F0E95_C2D8_47B1_9E04_B85C17A2F6D3
+#define INCLUDED_SharedPoseReader_h_GUID_3A6F0E95_C2D8_47B1_9E04_B85C17A2F6D3
+
+// Internal Includes
+#include "SharedPoseLayout.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cstdint>
+#include <string>
+
+namespace osvr {
+namespace vive {
+
+    /// Reads poses from a segment the plugin publishes them to (see the
+    /// sharedPoseMemory config option). Reading never blocks the plugin,
+    /// and never sees a pose half-written.
+    ///
+    /// Any number of readers, in any number of processes; one object may be
+    /// read from any number of threads once open.
+    class SharedPoseReader {
+      public:
+        SharedPoseReader() = default;
+        ~SharedPoseReader();
+
+        SharedPoseReader(SharedPoseReader const &) = delete;
+        SharedPoseReader &operator=(SharedPoseReader const &) = delete;
+
+        /// Map the named segment, read-only.
+        /// @return false if it doesn't exist (yet) or isn't one this
+        /// library can read; getError() says which.
+        bool open(std::string const &name);
+        void close();
+
+        bool isOpen() const { return segment_ != nullptr; }
+        std::string const &getError() const { return error_; }
+
+        /// Whether the plugin still has the segment open. Once it doesn't,
+        /// close and re-open to follow the next one.
+        bool isWriterActive() const;
+
+        /// Changes each time a writer sets the segment up.
+        std::uint32_t getGeneration() const;
+
+        /// Copy out the latest pose for a sensor of one of the plugin's
+        /// devices (0 for "Vive", 1 for "Vive2", ...).
+        /// @param sequence If not null, set to the slot's sequence number,
+        /// which changes with every pose published there - for telling
+        /// whether a pose is new.
+        /// @return false if there's no pose for it (yet).
+        bool read(std::uint32_t device, std::uint32_t sensor,
+                  shared_pose::PoseData &out,
+                  std::uint32_t *sequence = nullptr) const;
+
+        /// Copy out the latest pose for a sensor of the first device.
+        bool read(std::uint32_t sensor, shared_pose::PoseData &out,
+                  std::uint32_t *sequence = nullptr) const {
+            return read(0, sensor, out, sequence);
+        }
+
+      private:
+        shared_pose::Segment const *segment_ = nullptr;
+        std::string error_;
+    };
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_SharedPoseReader_h_GUID_3A6F0E95_C2D8_47B1_9E04_B85C17A2F6D3
@@ -0,0 +1,132 @@
+/** @file
+    @brief Implementation
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "SharedPoseSink.h"
+#include "Logger.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cstring>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace osvr {
+namespace vive {
+    using namespace shared_pose;
+
+    SharedPoseSink::~SharedPoseSink() { close(); }
+
+#ifdef _WIN32
+    bool SharedPoseSink::open(std::string const &) {
+        logWarn() << "Publishing poses to shared memory isn't supported on "
+                     "this platform.";
+        return false;
+    }
+
+    void SharedPoseSink::close() {}
+#else
+    bool SharedPoseSink::open(std::string const &name) {
+        close();
+        int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+        if (fd < 0) {
+            logWarn() << "Could not create shared memory segment " << name
+                      << " for poses: " << std::strerror(errno);
+            return false;
+        }
+        if (ftruncate(fd, sizeof(Segment)) != 0) {
+            logWarn() << "Could not size shared memory segment " << name
+                      << " for poses: " << std::strerror(errno);
+            ::close(fd);
+            shm_unlink(name.c_str());
+            return false;
+        }
+        auto mem = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+        /// The mapping keeps the segment alive without the descriptor.
+        ::close(fd);
+        if (MAP_FAILED == mem) {
+            logWarn() << "Could not map shared memory segment " << name
+                      << " for poses: " << std::strerror(errno);
+            shm_unlink(name.c_str());
+            return false;
+        }
+        segment_ = static_cast<Segment *>(mem);
+        name_ = name;
+
+        /// Whatever an earlier run left behind - a crashed one, say - isn't
+        /// valid any more. Readers go by the magic number, so clear that
+        /// first and set it last.
+        auto &header = segment_->header;
+        header.magic.store(0, std::memory_order_relaxed);
+        header.version = VERSION;
+        header.slotCount = SLOT_COUNT;
+        header.slotSize = sizeof(Slot);
+        for (std::uint32_t i = 0; i < SLOT_COUNT; ++i) {
+            segment_->slots[i].sequence.store(0, std::memory_order_relaxed);
+            std::memset(&segment_->slots[i].data, 0, sizeof(PoseData));
+        }
+        header.generation.fetch_add(1, std::memory_order_relaxed);
+        header.writerActive.store(1, std::memory_order_relaxed);
+        header.magic.store(MAGIC, std::memory_order_release);
+        logInfo() << "Publishing poses to shared memory segment " << name;
+        return true;
+    }
+
+    void SharedPoseSink::close() {
+        if (!segment_) {
+            return;
+        }
+        segment_->header.writerActive.store(0, std::memory_order_release);
+        munmap(segment_, sizeof(Segment));
+        shm_unlink(name_.c_str());
+        segment_ = nullptr;
+    }
+#endif
+
+    void SharedPoseSink::publish(PoseData const &data) {
+        if (!segment_ || !(data.device < DEVICE_COUNT) ||
+            !(data.sensor < SENSORS_PER_DEVICE)) {
+            return;
+        }
+        auto &slot =
+            segment_->slots[data.device * SENSORS_PER_DEVICE + data.sensor];
+        auto seq = slot.sequence.load(std::memory_order_relaxed);
+        /// Odd while writing: the fence keeps the data writes after it.
+        slot.sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.data, &data, sizeof(data));
+        slot.sequence.store(seq + 2, std::memory_order_release);
+    }
+
+} // namespace vive
+} // namespace osvr
@@ -0,0 +1,77 @@
+/** @file
+    @brief Header for publishing the plugin's poses into POSIX shared memory,
+    for readers on the same machine that want them without going through
+    OSVR.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SharedPoseSink_h_GUID_E0B84C61_2F7A_4D93_8C55_19A6D3F0E2B8
+#define INCLUDED_SharedPoseSink_h_GUID_E0B84C61_2F7A_4D93_8C55_19A6D3F0E2B8
+
+// Internal Includes
+#include "SharedPoseLayout.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <string>
+
+namespace osvr {
+namespace vive {
+
+    /// Writes each sensor's latest pose into a shared-memory segment laid
+    /// out as in SharedPoseLayout.h, one seqlock-protected slot per sensor,
+    /// so a reader always gets a consistent pose without ever blocking the
+    /// writer. Only available on POSIX systems.
+    ///
+    /// Single writer: publish() from one thread only.
+    class SharedPoseSink {
+      public:
+        SharedPoseSink() = default;
+        /// Marks the segment inactive and removes its name.
+        ~SharedPoseSink();
+
+        SharedPoseSink(SharedPoseSink const &) = delete;
+        SharedPoseSink &operator=(SharedPoseSink const &) = delete;
+
+        /// Create the named segment (a POSIX shared memory name, like
+        /// "/osvr-vive-poses"), or take over one left behind.
+        /// @return false, having logged why, if that didn't work.
+        bool open(std::string const &name);
+
+        bool isOpen() const { return segment_ != nullptr; }
+
+        /// Publish a sensor's latest pose, into the slot for data.sensor.
+        void publish(shared_pose::PoseData const &data);
+
+      private:
+        void close();
+
+        shared_pose::Segment *segment_ = nullptr;
+        std::string name_;
+    };
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_SharedPoseSink_h_GUID_E0B84C61_2F7A_4D93_8C55_19A6D3F0E2B8
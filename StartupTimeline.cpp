@@ -0,0 +1,134 @@
+/** @file
+    @brief Implementation
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "StartupTimeline.h"
+
+// Library/third-party includes
+#include <json/value.h>
+#include <json/writer.h>
+
+// Standard includes
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace osvr {
+namespace vive {
+
+    template <typename Duration>
+    static inline double toMilliseconds(Duration const &d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+
+    template <typename Duration>
+    static inline double toMicroseconds(Duration const &d) {
+        return std::chrono::duration<double, std::micro>(d).count();
+    }
+
+    StartupTimeline &StartupTimeline::instance() {
+        static StartupTimeline timeline;
+        return timeline;
+    }
+
+    StartupTimeline::StartupTimeline() : origin_(clock::now()) {}
+
+    void StartupTimeline::reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        origin_ = clock::now();
+        phases_.clear();
+        threads_.clear();
+    }
+
+    void StartupTimeline::record(std::string const &name,
+                                 clock::time_point start,
+                                 clock::time_point end) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = threads_.find(std::this_thread::get_id());
+        if (it == threads_.end()) {
+            it = threads_
+                     .emplace(std::this_thread::get_id(), threads_.size() + 1)
+                     .first;
+        }
+        phases_.push_back(
+            Phase{name, start - origin_, end - start, it->second});
+    }
+
+    std::vector<StartupTimeline::Phase> StartupTimeline::getPhases() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return phases_;
+    }
+
+    std::string StartupTimeline::summary() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        /// Phases are recorded as they end, so nested ones come first:
+        /// present them in the order they started instead.
+        auto phases = phases_;
+        std::stable_sort(phases.begin(), phases.end(),
+                         [](Phase const &a, Phase const &b) {
+                             return a.start < b.start;
+                         });
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(1)
+           << "startup total=" << toMilliseconds(clock::now() - origin_)
+           << "ms";
+        for (auto const &phase : phases) {
+            os << " " << phase.name << "=" << toMilliseconds(phase.duration)
+               << "ms";
+        }
+        return os.str();
+    }
+
+    bool StartupTimeline::writeChromeTrace(std::string const &fn) const {
+        Json::Value root(Json::objectValue);
+        auto &events = root["traceEvents"];
+        events = Json::Value(Json::arrayValue);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto const &phase : phases_) {
+                Json::Value ev(Json::objectValue);
+                ev["name"] = phase.name;
+                ev["cat"] = "startup";
+                /// Complete event: has both a start and a duration.
+                ev["ph"] = "X";
+                ev["ts"] = toMicroseconds(phase.start);
+                ev["dur"] = toMicroseconds(phase.duration);
+                ev["pid"] = 1;
+                ev["tid"] = static_cast<Json::UInt>(phase.thread);
+                events.append(ev);
+            }
+        }
+        root["displayTimeUnit"] = "ms";
+
+        std::ofstream os(fn, std::ios::out | std::ios::trunc);
+        if (!os) {
+            return false;
+        }
+        os << Json::StyledWriter().write(root);
+        return static_cast<bool>(os.flush());
+    }
+
+} // namespace vive
+} // namespace osvr
@@ -0,0 +1,114 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_StartupTimeline_h_GUID_6B2E8D47_1F93_4C0A_9E75_3A4D1C8B2F60
+#define INCLUDED_StartupTimeline_h_GUID_6B2E8D47_1F93_4C0A_9E75_3A4D1C8B2F60
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace osvr {
+namespace vive {
+
+    /// Records how long each phase of driver startup took, so slow startups
+    /// can be tracked down to a phase.
+    ///
+    /// There's one per process, since the phases are spread across the loader
+    /// library with no common object to hang it on. Phases are coarse, so
+    /// recording just takes a mutex. Thread-safe.
+    class StartupTimeline {
+      public:
+        using clock = std::chrono::steady_clock;
+
+        struct Phase {
+            std::string name;
+            /// Relative to the start of the timeline.
+            clock::duration start;
+            clock::duration duration;
+            /// Small integer standing in for the thread it ran on.
+            std::size_t thread;
+        };
+
+        static StartupTimeline &instance();
+
+        /// Forget recorded phases and restart the clock - call at the start
+        /// of each startup attempt.
+        void reset();
+
+        void record(std::string const &name, clock::time_point start,
+                    clock::time_point end);
+
+        std::vector<Phase> getPhases() const;
+
+        /// One line: total elapsed time followed by name=milliseconds for
+        /// each phase, in the order they started.
+        std::string summary() const;
+
+        /// Write the phases as a Chrome trace (chrome://tracing, or
+        /// https://ui.perfetto.dev) JSON file.
+        /// @return false if the file couldn't be written.
+        bool writeChromeTrace(std::string const &fn) const;
+
+      private:
+        StartupTimeline();
+        mutable std::mutex mutex_;
+        clock::time_point origin_;
+        std::vector<Phase> phases_;
+        std::map<std::thread::id, std::size_t> threads_;
+    };
+
+    /// RAII helper recording a phase from construction to destruction.
+    class StartupPhase {
+      public:
+        explicit StartupPhase(std::string name)
+            : name_(std::move(name)), start_(StartupTimeline::clock::now()) {}
+        ~StartupPhase() {
+            StartupTimeline::instance().record(
+                name_, start_, StartupTimeline::clock::now());
+        }
+        StartupPhase(StartupPhase const &) = delete;
+        StartupPhase &operator=(StartupPhase const &) = delete;
+
+      private:
+        std::string name_;
+        StartupTimeline::clock::time_point start_;
+    };
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_StartupTimeline_h_GUID_6B2E8D47_1F93_4C0A_9E75_3A4D1C8B2F60
@@ -0,0 +1,430 @@
+/** @file
+    @brief Tool to hammer ViveDriverHost's report submission from several
+    driver threads at once while the main loop drains it, checking that
+    nothing is lost or reordered.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "Logger.h"
+#include "OSVRViveTracker.h"
+#include "StubPluginKit.h"
+
+// Library/third-party includes
+#include <openvr_driver.h>
+
+// Standard includes
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace osvr::vive;
+
+static const auto PREFIX = "[ViveStressTest] ";
+
+/// Analog values step up by this much per event, so each one is distinct
+/// and they only ever increase.
+static const double ANALOG_STEP = 1e-6;
+/// Added to trackpad y values, to tell them apart from x.
+static const double Y_OFFSET = 0.5;
+
+/// The value of the n'th axis update, as the host gets it.
+static double axisValue(std::size_t n, bool y) {
+    return static_cast<float>((y ? Y_OFFSET : 0.) + n * ANALOG_STEP);
+}
+
+struct Options {
+    std::size_t producerThreads = 4;
+    /// Each producer thread plays the driver for this many devices.
+    std::size_t devicesPerThread = 2;
+    /// Poses per device; buttons and axes come along at a fraction of it.
+    std::size_t posesPerDevice = 100000;
+    /// Microseconds between a producer's poses; 0 for flat out.
+    std::size_t poseInterval = 0;
+    /// Microseconds the main loop sleeps between updates; 0 to just yield.
+    std::size_t updateInterval = 0;
+    bool coalesceAnalogs = false;
+    /// The devices are split evenly between this many HMDs' device groups.
+    std::size_t hmds = 1;
+};
+
+static void usage(const char *argv0) {
+    std::cerr
+        << "Usage: " << argv0
+        << " [--threads <n>] [--devices-per-thread <n>] [--poses <n>]\n"
+           "    [--pose-interval <microseconds>] [--update-interval "
+           "<microseconds>] [--coalesce] [--hmds <n>]\n\n"
+           "Calls the driver host's pose, button, and axis callbacks from\n"
+           "several threads at once, each thread acting for its own set of\n"
+           "devices, while the main thread runs updates the way the server\n"
+           "would. Then checks that every report was sent, in the order each\n"
+           "device made them. Exits non-zero if not.\n"
+           "  --threads              Producer threads (default 4)\n"
+           "  --devices-per-thread   Devices each one drives (default 2)\n"
+           "  --poses                Poses per device (default 100000)\n"
+           "  --pose-interval        Sleep between a thread's poses "
+           "(default 0)\n"
+           "  --update-interval      Sleep between updates (default 0)\n"
+           "  --coalesce             Turn on coalesceAnalogs, so only the "
+           "latest analog\n"
+           "                         value per update need arrive\n"
+           "  --hmds                 Split the devices between this many "
+           "HMDs, each with\n"
+           "                         an OSVR device of its own (default 1)\n"
+        << std::endl;
+}
+
+static bool parseCount(const char *s, std::size_t &out) {
+    auto v = std::atol(s);
+    if (v < 0) {
+        return false;
+    }
+    out = static_cast<std::size_t>(v);
+    return true;
+}
+
+static bool parseArgs(int argc, char *argv[], Options &opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool haveValue = i + 1 < argc;
+        bool ok = true;
+        if (arg == "--coalesce") {
+            opts.coalesceAnalogs = true;
+        } else if (arg == "--threads" && haveValue) {
+            ok = parseCount(argv[++i], opts.producerThreads);
+        } else if (arg == "--devices-per-thread" && haveValue) {
+            ok = parseCount(argv[++i], opts.devicesPerThread);
+        } else if (arg == "--poses" && haveValue) {
+            ok = parseCount(argv[++i], opts.posesPerDevice);
+        } else if (arg == "--pose-interval" && haveValue) {
+            ok = parseCount(argv[++i], opts.poseInterval);
+        } else if (arg == "--update-interval" && haveValue) {
+            ok = parseCount(argv[++i], opts.updateInterval);
+        } else if (arg == "--hmds" && haveValue) {
+            ok = parseCount(argv[++i], opts.hmds);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    if (opts.hmds == 0 || opts.hmds > MAX_HMDS) {
+        std::cerr << PREFIX << "Need between 1 and " << MAX_HMDS << " HMDs."
+                  << std::endl;
+        return false;
+    }
+    auto devices = opts.producerThreads * opts.devicesPerThread;
+    if (devices == 0 || devices % opts.hmds != 0 ||
+        devices / opts.hmds > MAX_SENSORS) {
+        std::cerr << PREFIX << "Need between 1 and " << MAX_SENSORS
+                  << " devices per HMD, the same number for each."
+                  << std::endl;
+        return false;
+    }
+    return opts.posesPerDevice > 0;
+}
+
+/// A button change every this many poses, and an axis update every this
+/// many: roughly the proportions real input comes in at.
+static const std::size_t POSES_PER_BUTTON = 50;
+static const std::size_t POSES_PER_AXIS = 4;
+
+static vr::DriverPose_t makePose(std::size_t seq) {
+    vr::DriverPose_t pose;
+    std::memset(&pose, 0, sizeof(pose));
+    /// Identity transforms all round, so the x translation that comes out
+    /// is the sequence number that went in.
+    pose.qRotation.w = 1;
+    pose.qDriverFromHeadRotation.w = 1;
+    pose.qWorldFromDriverRotation.w = 1;
+    pose.vecPosition[0] = static_cast<double>(seq);
+    pose.poseIsValid = true;
+    pose.deviceIsConnected = true;
+    pose.result = vr::TrackingResult_Running_OK;
+    return pose;
+}
+
+/// Act as the driver for the given devices: a stream of poses, with button
+/// presses and releases and trackpad movement mixed in for controllers.
+static void produce(ViveDriverHost &host, std::vector<std::uint32_t> devices,
+                    Options const &opts, std::atomic<bool> &go) {
+    while (!go) {
+        std::this_thread::yield();
+    }
+    for (std::size_t seq = 0; seq < opts.posesPerDevice; ++seq) {
+        for (auto dev : devices) {
+            host.TrackedDevicePoseUpdated(dev, makePose(seq));
+            if (HMD_SENSOR == sensorForDeviceId(dev)) {
+                continue;
+            }
+            if (seq % POSES_PER_BUTTON == 0) {
+                auto n = seq / POSES_PER_BUTTON;
+                if (n % 2 == 0) {
+                    host.TrackedDeviceButtonPressed(
+                        dev, vr::k_EButton_SteamVR_Trigger, 0);
+                } else {
+                    host.TrackedDeviceButtonUnpressed(
+                        dev, vr::k_EButton_SteamVR_Trigger, 0);
+                }
+            }
+            if (seq % POSES_PER_AXIS == 0) {
+                auto n = seq / POSES_PER_AXIS + 1;
+                vr::VRControllerAxis_t state;
+                state.x = static_cast<float>(axisValue(n, false));
+                state.y = static_cast<float>(axisValue(n, true));
+                host.TrackedDeviceAxisUpdated(dev, 0, state);
+            }
+        }
+        if (opts.poseInterval > 0) {
+            std::this_thread::sleep_for(
+                std::chrono::microseconds(opts.poseInterval));
+        }
+    }
+}
+
+/// Tallies the values sent on each channel, in order.
+struct Channel {
+    std::size_t count = 0;
+    /// Values that weren't greater than the one before.
+    std::size_t outOfOrder = 0;
+    /// Values the same as the one before.
+    std::size_t repeats = 0;
+    double last = 0;
+};
+/// Channels are per OSVR device: one for each HMD's group.
+using ChannelKey = std::pair<std::size_t, OSVR_ChannelCount>;
+using ChannelMap = std::map<ChannelKey, Channel>;
+
+static ChannelMap tally(stub_pluginkit::SendType type) {
+    ChannelMap channels;
+    for (auto const &sent : stub_pluginkit::getStats(type).values) {
+        auto &channel = channels[ChannelKey(sent.device, sent.sensor)];
+        if (channel.count > 0) {
+            if (!(sent.value > channel.last)) {
+                channel.outOfOrder++;
+            }
+            if (sent.value == channel.last) {
+                channel.repeats++;
+            }
+        }
+        channel.last = sent.value;
+        channel.count++;
+    }
+    return channels;
+}
+
+static std::size_t g_failures = 0;
+
+static void fail(const char *kind, ChannelKey const &channel,
+                 std::string const &what) {
+    std::cout << PREFIX << "FAIL: " << kind << " channel " << channel.second;
+    if (channel.first > 0) {
+        std::cout << " of device " << channel.first;
+    }
+    std::cout << ": " << what << std::endl;
+    g_failures++;
+}
+
+static void checkCount(const char *kind, ChannelKey const &channel,
+                       std::size_t count, std::size_t expected) {
+    if (count != expected) {
+        fail(kind, channel, "sent " + std::to_string(count) + " of " +
+                                std::to_string(expected));
+    }
+}
+
+/// Whether everything the producers made was sent, in order. Poses go out
+/// on the device's sensor; buttons and analogs on channels the host picks,
+/// but each controller gets channels of its own, and they all made the same
+/// number of each.
+static bool verify(Options const &opts,
+                   std::vector<std::uint32_t> const &deviceIds,
+                   std::size_t numControllers) {
+    using stub_pluginkit::SendType;
+    auto poses = tally(SendType::Pose);
+    auto buttons = tally(SendType::Button);
+    auto analogs = tally(SendType::Analog);
+
+    auto expectedPoses = opts.posesPerDevice;
+    auto expectedButtons =
+        (opts.posesPerDevice + POSES_PER_BUTTON - 1) / POSES_PER_BUTTON;
+    auto expectedAxes =
+        (opts.posesPerDevice + POSES_PER_AXIS - 1) / POSES_PER_AXIS;
+
+    for (auto id : deviceIds) {
+        ChannelKey key(groupForDeviceId(id), sensorForDeviceId(id));
+        auto const &pose = poses[key];
+        checkCount("pose", key, pose.count, expectedPoses);
+        if (pose.outOfOrder > 0) {
+            fail("pose", key, std::to_string(pose.outOfOrder) +
+                                  " out of order");
+        }
+    }
+
+    /// One trigger channel per controller.
+    if (buttons.size() != numControllers) {
+        fail("button", ChannelKey(),
+             "sent on " + std::to_string(buttons.size()) +
+                 " channels, expected " + std::to_string(numControllers));
+    }
+    for (auto const &entry : buttons) {
+        checkCount("button", entry.first, entry.second.count,
+                   expectedButtons);
+        /// Presses and releases alternate, so there should never be two of
+        /// the same in a row.
+        if (entry.second.repeats > 0) {
+            fail("button", entry.first,
+                 std::to_string(entry.second.repeats) + " out of order");
+        }
+    }
+
+    /// Trackpad x and y channels for each controller.
+    if (analogs.size() != 2 * numControllers) {
+        fail("analog", ChannelKey(),
+             "sent on " + std::to_string(analogs.size()) +
+                 " channels, expected " + std::to_string(2 * numControllers));
+    }
+    auto lastX = axisValue(expectedAxes, false);
+    auto lastY = axisValue(expectedAxes, true);
+    for (auto const &entry : analogs) {
+        auto const &analog = entry.second;
+        if (opts.coalesceAnalogs) {
+            /// Some may have been superseded before they were sent, but the
+            /// latest one must make it.
+            auto expectedLast = analog.last < Y_OFFSET ? lastX : lastY;
+            if (analog.last != expectedLast) {
+                fail("analog", entry.first,
+                     "last value sent wasn't the latest made");
+            }
+        } else {
+            checkCount("analog", entry.first, analog.count, expectedAxes);
+        }
+        if (analog.outOfOrder > 0) {
+            fail("analog", entry.first,
+                 std::to_string(analog.outOfOrder) + " out of order");
+        }
+    }
+    return g_failures == 0;
+}
+
+int main(int argc, char *argv[]) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        usage(argv[0]);
+        return 1;
+    }
+    auto numDevices = static_cast<std::uint32_t>(opts.producerThreads *
+                                                 opts.devicesPerThread);
+    auto numHmds = static_cast<std::uint32_t>(opts.hmds);
+
+    PluginConfig config;
+    /// The devices are made up: don't remember their sensor IDs in a file.
+    config.sensorIdMapFile.clear();
+    config.coalesceAnalogs = opts.coalesceAnalogs;
+    config.maxHmds = numHmds;
+    DriverHostPtr host(new ViveDriverHost);
+    host->startWithoutDriver(config);
+    host->registerDevice(stub_pluginkit::getContext());
+    /// Each HMD's group gets an HMD and the same number of controllers.
+    std::vector<std::uint32_t> deviceIds;
+    for (std::uint32_t group = 0; group < numHmds; ++group) {
+        for (std::uint32_t sensor = 0; sensor < numDevices / numHmds;
+             ++sensor) {
+            auto id = deviceIdFor(group, sensor);
+            host->activateReplayedDevice(
+                id, HMD_SENSOR == sensor ? DeviceRole::HMD
+                                         : DeviceRole::Controller,
+                "STRESS-" + std::to_string(id));
+            deviceIds.push_back(id);
+        }
+    }
+    /// Take in the new devices before starting the clock.
+    stub_pluginkit::runUpdate();
+    stub_pluginkit::resetStats();
+    stub_pluginkit::setKeepSentValues(true);
+
+    /// Deal the devices out round-robin, so the HMD's thread has
+    /// controllers too.
+    std::vector<std::vector<std::uint32_t> > devicesByThread(
+        opts.producerThreads);
+    for (std::size_t i = 0; i < deviceIds.size(); ++i) {
+        devicesByThread[i % opts.producerThreads].push_back(deviceIds[i]);
+    }
+    std::atomic<bool> go{false};
+    std::atomic<std::size_t> running{opts.producerThreads};
+    std::vector<std::thread> producers;
+    for (auto const &devices : devicesByThread) {
+        producers.emplace_back([&, devices] {
+            produce(*host, devices, opts, go);
+            running--;
+        });
+    }
+
+    std::size_t updates = 0;
+    auto start = std::chrono::steady_clock::now();
+    go = true;
+    while (running > 0) {
+        stub_pluginkit::runUpdate();
+        updates++;
+        if (opts.updateInterval > 0) {
+            std::this_thread::sleep_for(
+                std::chrono::microseconds(opts.updateInterval));
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto &t : producers) {
+        t.join();
+    }
+    /// Whatever came in after the last one.
+    stub_pluginkit::runUpdate();
+    auto seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    Logger::instance().flush();
+
+    using stub_pluginkit::SendType;
+    auto total = stub_pluginkit::getStats(SendType::Pose).count +
+                 stub_pluginkit::getStats(SendType::Button).count +
+                 stub_pluginkit::getStats(SendType::Analog).count;
+    std::cout << PREFIX << opts.producerThreads << " threads, " << numHmds
+              << " HMDs, " << numDevices << " devices: " << total
+              << " reports sent in " << seconds << " seconds ("
+              << static_cast<std::uint64_t>(total / seconds) << "/s) over "
+              << updates << " updates" << std::endl;
+
+    if (!verify(opts, deviceIds, numDevices - numHmds)) {
+        std::cout << PREFIX << g_failures << " checks failed." << std::endl;
+        return 1;
+    }
+    std::cout << PREFIX << "All reports sent, in order." << std::endl;
+    return 0;
+}
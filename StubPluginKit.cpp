@@ -0,0 +1,194 @@
+/** @file
+    @brief Implementation
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "StubPluginKit.h"
+
+// Library/third-party includes
+#include <osvr/PluginKit/AnalogInterfaceC.h>
+#include <osvr/PluginKit/ButtonInterfaceC.h>
+#include <osvr/PluginKit/TrackerInterfaceC.h>
+#include <osvr/Util/TimeValue.h>
+
+// Standard includes
+#include <utility>
+
+namespace osvr {
+namespace vive {
+    namespace stub_pluginkit {
+        namespace {
+            /// The opaque handles only need to be distinct and non-null.
+            char g_handleStorage[6];
+            template <typename T> T handle(std::size_t i) {
+                return reinterpret_cast<T>(&g_handleStorage[i]);
+            }
+
+            /// Device tokens point into here, so the token gives the index.
+            const std::size_t MAX_DEVICES = 16;
+            char g_deviceStorage[MAX_DEVICES];
+            std::vector<std::string> g_deviceNames;
+            inline std::size_t deviceIndex(OSVR_DeviceToken device) {
+                return static_cast<std::size_t>(
+                    reinterpret_cast<char *>(device) - g_deviceStorage);
+            }
+
+            std::vector<std::pair<OSVR_DeviceUpdateCallback, void *>>
+                g_updateCallbacks;
+
+            SendStats g_stats[3];
+            bool g_keepSentValues = false;
+            bool g_keepLatencies = true;
+            std::uint64_t g_descriptorCount = 0;
+            std::string g_lastDescriptor;
+
+            inline void recordSend(OSVR_DeviceToken device, SendType type,
+                                   OSVR_TimeValue const *tv,
+                                   OSVR_ChannelCount sensor, double value) {
+                auto &stats = g_stats[static_cast<int>(type)];
+                stats.count++;
+                if (g_keepLatencies) {
+                    auto now = util::time::getNow();
+                    stats.latencies.push_back(util::time::duration(now, *tv));
+                }
+                if (g_keepSentValues) {
+                    stats.values.push_back(
+                        SentValue{sensor, value, deviceIndex(device)});
+                }
+            }
+        } // namespace
+
+        OSVR_PluginRegContext getContext() {
+            return handle<OSVR_PluginRegContext>(0);
+        }
+
+        bool runUpdate() {
+            for (auto const &callback : g_updateCallbacks) {
+                callback.first(callback.second);
+            }
+            return !g_updateCallbacks.empty();
+        }
+
+        std::vector<std::string> const &getDeviceNames() {
+            return g_deviceNames;
+        }
+
+        SendStats const &getStats(SendType type) {
+            return g_stats[static_cast<int>(type)];
+        }
+
+        std::uint64_t getDescriptorCount() { return g_descriptorCount; }
+
+        std::string const &getLastDescriptor() { return g_lastDescriptor; }
+
+        void resetStats() {
+            for (auto &stats : g_stats) {
+                stats = SendStats{};
+            }
+            g_descriptorCount = 0;
+        }
+
+        void setKeepSentValues(bool keep) { g_keepSentValues = keep; }
+
+        void setKeepLatencies(bool keep) { g_keepLatencies = keep; }
+
+    } // namespace stub_pluginkit
+} // namespace vive
+} // namespace osvr
+
+using namespace osvr::vive::stub_pluginkit;
+
+OSVR_DeviceInitOptions osvrDeviceCreateInitOptions(OSVR_PluginRegContext) {
+    return handle<OSVR_DeviceInitOptions>(1);
+}
+
+OSVR_ReturnCode osvrDeviceSyncInitWithOptions(OSVR_PluginRegContext,
+                                              const char *name,
+                                              OSVR_DeviceInitOptions,
+                                              OSVR_DeviceToken *device) {
+    if (!(g_deviceNames.size() < MAX_DEVICES)) {
+        return OSVR_RETURN_FAILURE;
+    }
+    *device = reinterpret_cast<OSVR_DeviceToken>(
+        &g_deviceStorage[g_deviceNames.size()]);
+    g_deviceNames.emplace_back(name);
+    return OSVR_RETURN_SUCCESS;
+}
+
+OSVR_ReturnCode osvrDeviceSendJsonDescriptor(OSVR_DeviceToken,
+                                             const char *json, size_t len) {
+    g_descriptorCount++;
+    g_lastDescriptor.assign(json, len);
+    return OSVR_RETURN_SUCCESS;
+}
+
+OSVR_ReturnCode
+osvrDeviceRegisterUpdateCallback(OSVR_DeviceToken,
+                                 OSVR_DeviceUpdateCallback updateCallback,
+                                 void *userData) {
+    g_updateCallbacks.emplace_back(updateCallback, userData);
+    return OSVR_RETURN_SUCCESS;
+}
+
+OSVR_ReturnCode osvrDeviceTrackerConfigure(OSVR_DeviceInitOptions,
+                                           OSVR_TrackerDeviceInterface *iface) {
+    *iface = handle<OSVR_TrackerDeviceInterface>(3);
+    return OSVR_RETURN_SUCCESS;
+}
+
+OSVR_ReturnCode osvrDeviceAnalogConfigure(OSVR_DeviceInitOptions,
+                                          OSVR_AnalogDeviceInterface *iface,
+                                          OSVR_ChannelCount) {
+    *iface = handle<OSVR_AnalogDeviceInterface>(4);
+    return OSVR_RETURN_SUCCESS;
+}
+
+OSVR_ReturnCode osvrDeviceButtonConfigure(OSVR_DeviceInitOptions,
+                                          OSVR_ButtonDeviceInterface *iface,
+                                          OSVR_ChannelCount) {
+    *iface = handle<OSVR_ButtonDeviceInterface>(5);
+    return OSVR_RETURN_SUCCESS;
+}
+
+OSVR_ReturnCode osvrDeviceTrackerSendPoseTimestamped(
+    OSVR_DeviceToken device, OSVR_TrackerDeviceInterface,
+    OSVR_PoseState const *val, OSVR_ChannelCount sensor,
+    OSVR_TimeValue const *timestamp) {
+    recordSend(device, SendType::Pose, timestamp, sensor,
+               val->translation.data[0]);
+    return OSVR_RETURN_SUCCESS;
+}
+
+OSVR_ReturnCode osvrDeviceButtonSetValueTimestamped(
+    OSVR_DeviceToken device, OSVR_ButtonDeviceInterface, OSVR_ButtonState val,
+    OSVR_ChannelCount sensor, OSVR_TimeValue const *timestamp) {
+    recordSend(device, SendType::Button, timestamp, sensor, val);
+    return OSVR_RETURN_SUCCESS;
+}
+
+OSVR_ReturnCode osvrDeviceAnalogSetValueTimestamped(
+    OSVR_DeviceToken device, OSVR_AnalogDeviceInterface, OSVR_AnalogState val,
+    OSVR_ChannelCount sensor, OSVR_TimeValue const *timestamp) {
+    recordSend(device, SendType::Analog, timestamp, sensor, val);
+    return OSVR_RETURN_SUCCESS;
+}
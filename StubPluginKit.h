@@ -0,0 +1,101 @@
+/** @file
+    @brief Header for a stand-in for the parts of the OSVR PluginKit C API
+    that ViveDriverHost uses, for running it outside of an OSVR server.
+
+    Link StubPluginKit.cpp in place of the real PluginKit library: instead of
+    going to a server, everything sent is counted, and the delay from each
+    report's timestamp to its send is recorded.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_StubPluginKit_h_GUID_5B0E3F27_A84C_4D19_B6E1_7F2C09D3A486
+#define INCLUDED_StubPluginKit_h_GUID_5B0E3F27_A84C_4D19_B6E1_7F2C09D3A486
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+#include <osvr/PluginKit/PluginKit.h>
+
+// Standard includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osvr {
+namespace vive {
+    namespace stub_pluginkit {
+
+        enum class SendType { Pose, Button, Analog };
+
+        /// What a send carried, when keeping them: the x translation for
+        /// poses, the state for buttons, the value for analogs.
+        struct SentValue {
+            OSVR_ChannelCount sensor;
+            double value;
+            /// Which device sent it, in the order they were initialized.
+            std::size_t device;
+        };
+
+        struct SendStats {
+            std::uint64_t count = 0;
+            /// Seconds from the timestamp on each report to when it was sent.
+            /// Only filled while setKeepLatencies(true), the default.
+            std::vector<double> latencies;
+            /// In the order sent; only filled after setKeepSentValues(true).
+            std::vector<SentValue> values;
+        };
+
+        /// A registration context to pass to ViveDriverHost::registerDevice()
+        OSVR_PluginRegContext getContext();
+
+        /// Call the update callbacks registered by the devices, like the
+        /// server's main loop would.
+        /// @return false if there aren't any.
+        bool runUpdate();
+
+        /// The names of the devices initialized, in order.
+        std::vector<std::string> const &getDeviceNames();
+
+        /// @name Results - only stable between runUpdate() calls
+        /// @{
+        SendStats const &getStats(SendType type);
+        std::uint64_t getDescriptorCount();
+        std::string const &getLastDescriptor();
+        /// @}
+
+        /// Clear the counts and latencies (but not the registered device).
+        void resetStats();
+
+        /// Whether to keep what each send carried, for checking order and
+        /// loss. Off by default.
+        void setKeepSentValues(bool keep);
+
+        /// Whether to keep each send's latency. On by default; turn it off
+        /// for sends to just be counted, without allocating.
+        void setKeepLatencies(bool keep);
+
+    } // namespace stub_pluginkit
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_StubPluginKit_h_GUID_5B0E3F27_A84C_4D19_B6E1_7F2C09D3A486
@@ -0,0 +1,257 @@
+/** @file
+    @brief Implementation
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "ThreadTuning.h"
+#include "Logger.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <mutex>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace osvr {
+namespace vive {
+#ifdef __linux__
+    namespace {
+        /// Linux keeps this many characters of a thread name.
+        static const std::size_t MAX_THREAD_NAME = 15;
+
+        struct OwnedThreadEntry {
+            std::string name;
+            pthread_t handle;
+            pid_t tid;
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            ThreadSettings pump;
+            ThreadSettings driver;
+            ThreadSettings worker;
+            std::vector<OwnedThreadEntry> owned;
+
+            ThreadSettings const &get(ThreadRole role) const {
+                switch (role) {
+                case ThreadRole::Pump:
+                    return pump;
+                case ThreadRole::Driver:
+                    return driver;
+                case ThreadRole::Worker:
+                default:
+                    return worker;
+                }
+            }
+        };
+
+        /// Never destroyed: the log writer unregisters as it exits, which can
+        /// be after the other statics are gone.
+        Registry &registry() {
+            static Registry *reg = new Registry;
+            return *reg;
+        }
+
+        const char *roleName(ThreadRole role) {
+            switch (role) {
+            case ThreadRole::Pump:
+                return "pump";
+            case ThreadRole::Driver:
+                return "driver";
+            case ThreadRole::Worker:
+            default:
+                return "worker";
+            }
+        }
+
+        pid_t currentTid() { return static_cast<pid_t>(syscall(SYS_gettid)); }
+
+        void warnFailure(std::string const &thread, std::string const &what,
+                         int err) {
+            logWarn() << "Could not set " << what << " for " << thread << ": "
+                      << std::strerror(err)
+                      << (EPERM == err
+                              ? " (needs CAP_SYS_NICE, or a high enough "
+                                "rtprio/nice limit)"
+                              : "")
+                      << ". Carrying on without it.";
+        }
+
+        /// @return whether everything asked for was applied.
+        bool apply(ThreadSettings const &settings, std::string const &thread,
+                   pthread_t handle, pid_t tid) {
+            bool ok = true;
+            if (settings.realtimePriority > 0) {
+                sched_param param;
+                std::memset(&param, 0, sizeof(param));
+                param.sched_priority = settings.realtimePriority;
+                auto err = pthread_setschedparam(handle, SCHED_FIFO, &param);
+                if (err != 0) {
+                    warnFailure(thread,
+                                "SCHED_FIFO priority " +
+                                    std::to_string(settings.realtimePriority),
+                                err);
+                    ok = false;
+                }
+            }
+            if (settings.setNice) {
+                if (setpriority(PRIO_PROCESS, static_cast<id_t>(tid),
+                                settings.nice) != 0) {
+                    warnFailure(thread,
+                                "nice value " + std::to_string(settings.nice),
+                                errno);
+                    ok = false;
+                }
+            }
+            if (!settings.cpus.empty()) {
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                std::string list;
+                for (auto cpu : settings.cpus) {
+                    if (!(cpu < CPU_SETSIZE)) {
+                        logWarn() << "Skipping CPU " << cpu << " for "
+                                  << thread << ": out of range.";
+                        continue;
+                    }
+                    CPU_SET(cpu, &cpus);
+                    list += (list.empty() ? "" : ",") + std::to_string(cpu);
+                }
+                auto err = pthread_setaffinity_np(handle, sizeof(cpus), &cpus);
+                if (err != 0) {
+                    warnFailure(thread, "CPU affinity " + list, err);
+                    ok = false;
+                }
+            }
+            return ok;
+        }
+    } // namespace
+#endif
+
+    void configureThreads(ThreadSettings const &pump,
+                          ThreadSettings const &driver,
+                          ThreadSettings const &worker) {
+#ifdef __linux__
+        auto &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.pump = pump;
+        reg.driver = driver;
+        reg.worker = worker;
+        if (worker.empty()) {
+            return;
+        }
+        /// The lock keeps these threads from exiting while we're at them.
+        for (auto const &entry : reg.owned) {
+            if (apply(worker, "thread " + entry.name, entry.handle,
+                      entry.tid)) {
+                OSVR_VIVE_LOG_DEBUG("Applied worker thread settings to "
+                                    << entry.name);
+            }
+        }
+#else
+        if (!pump.empty() || !driver.empty() || !worker.empty()) {
+            logWarn() << "Thread priority and affinity options are only "
+                         "supported on Linux: ignoring them.";
+        }
+#endif
+    }
+
+    namespace detail {
+        bool &currentThreadTuned() {
+            static thread_local bool tuned = false;
+            return tuned;
+        }
+
+        void tuneCurrentThread(ThreadRole role) {
+#ifdef __linux__
+            ThreadSettings settings;
+            {
+                auto &reg = registry();
+                std::lock_guard<std::mutex> lock(reg.mutex);
+                settings = reg.get(role);
+            }
+            if (settings.empty()) {
+                return;
+            }
+            auto tid = currentTid();
+            auto thread = std::string(roleName(role)) + " thread " +
+                          std::to_string(tid);
+            if (apply(settings, thread, pthread_self(), tid)) {
+                OSVR_VIVE_LOG_DEBUG("Applied " << roleName(role)
+                                               << " thread settings to "
+                                               << thread);
+            }
+#else
+            (void)role;
+#endif
+        }
+    } // namespace detail
+
+    OwnedThread::OwnedThread(const char *name) : name_(name) {
+        /// Our own threads keep the worker settings, whatever else they do.
+        detail::currentThreadTuned() = true;
+#ifdef __linux__
+        pthread_setname_np(pthread_self(),
+                           name_.substr(0, MAX_THREAD_NAME).c_str());
+        OwnedThreadEntry entry;
+        entry.name = name_;
+        entry.handle = pthread_self();
+        entry.tid = currentTid();
+        ThreadSettings settings;
+        {
+            auto &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.owned.push_back(entry);
+            settings = reg.worker;
+        }
+        if (!settings.empty()) {
+            apply(settings, "thread " + name_, entry.handle, entry.tid);
+        }
+#endif
+    }
+
+    OwnedThread::~OwnedThread() {
+#ifdef __linux__
+        auto &reg = registry();
+        auto tid = currentTid();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (auto it = reg.owned.begin(); it != reg.owned.end(); ++it) {
+            if (it->tid == tid) {
+                reg.owned.erase(it);
+                break;
+            }
+        }
+#endif
+    }
+
+} // namespace vive
+} // namespace osvr
@@ -0,0 +1,112 @@
+/** @file
+    @brief Header for naming the plugin's threads and applying configured
+    scheduling priority and CPU affinity to them.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_ThreadTuning_h_GUID_E16014FF_7F22_4FE7_ADF0_64F9168AC7B7
+#define INCLUDED_ThreadTuning_h_GUID_E16014FF_7F22_4FE7_ADF0_64F9168AC7B7
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <string>
+#include <vector>
+
+namespace osvr {
+namespace vive {
+
+    /// Scheduling to apply to a kind of thread. The defaults leave the
+    /// thread as it was.
+    struct ThreadSettings {
+        /// SCHED_FIFO priority, from 1 to 99; 0 to leave the scheduling
+        /// policy alone.
+        int realtimePriority = 0;
+        /// Whether to set the thread's nice value, and to what (-20 to 19).
+        bool setNice = false;
+        int nice = 0;
+        /// CPUs the thread may run on; empty to leave its affinity alone.
+        std::vector<unsigned> cpus;
+
+        bool empty() const {
+            return 0 == realtimePriority && !setNice && cpus.empty();
+        }
+    };
+
+    enum class ThreadRole {
+        /// The thread calling the driver's RunFrame: the server's, through
+        /// the device update callback.
+        Pump,
+        /// Threads of the driver's that call back into the plugin.
+        Driver,
+        /// Background threads the plugin starts itself: the log writer, the
+        /// callback trace writer, and so on.
+        Worker
+    };
+
+    /// Set what to apply to each role's threads. The worker settings are
+    /// applied right away to the plugin's threads already running. Problems
+    /// are logged, never fatal. Only supported on Linux; elsewhere, any
+    /// settings given just get a warning.
+    void configureThreads(ThreadSettings const &pump,
+                          ThreadSettings const &driver,
+                          ThreadSettings const &worker);
+
+    namespace detail {
+        void tuneCurrentThread(ThreadRole role);
+        bool &currentThreadTuned();
+    } // namespace detail
+
+    /// Apply the settings for the role to the calling thread, unless it's
+    /// already had some applied - so a thread keeps the settings of the first
+    /// role it turns up in. Cheap after the first call on a thread.
+    inline void tuneThreadOnce(ThreadRole role) {
+        bool &tuned = detail::currentThreadTuned();
+        if (!tuned) {
+            tuned = true;
+            detail::tuneCurrentThread(role);
+        }
+    }
+
+    /// Put one of these at the top of the function each thread the plugin
+    /// starts runs: it names the thread (as shown by top and debuggers) and
+    /// gives it the worker settings, now or once they're configured.
+    class OwnedThread {
+      public:
+        /// @param name At most 15 characters are kept on Linux.
+        explicit OwnedThread(const char *name);
+        ~OwnedThread();
+        OwnedThread(OwnedThread const &) = delete;
+        OwnedThread &operator=(OwnedThread const &) = delete;
+
+      private:
+        std::string name_;
+    };
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_ThreadTuning_h_GUID_E16014FF_7F22_4FE7_ADF0_64F9168AC7B7
@@ -0,0 +1,134 @@
+/** @file
+    @brief Header for cheap monotonic timestamps for reports, converted to
+    OSVR time values only when sent.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_Timestamp_h_GUID_4E81C0B9_2F5D_4A67_93C2_A6D1F80B57E4
+#define INCLUDED_Timestamp_h_GUID_4E81C0B9_2F5D_4A67_93C2_A6D1F80B57E4
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+#include <osvr/Util/TimeValueC.h>
+
+// Standard includes
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace osvr {
+namespace vive {
+
+    /// A point in time, as integer microseconds on a monotonic clock: cheap
+    /// to read and to do arithmetic with in the driver callbacks. Turned into
+    /// the OSVR_TimeValue a report carries only when it's sent, by a
+    /// TimestampConverter.
+    class Timestamp {
+      public:
+        Timestamp() = default;
+
+        static Timestamp now() {
+            using namespace std::chrono;
+            return Timestamp(duration_cast<std::chrono::microseconds>(
+                                 steady_clock::now().time_since_epoch())
+                                 .count());
+        }
+
+        static Timestamp fromMicroseconds(std::int64_t us) {
+            return Timestamp(us);
+        }
+
+        std::int64_t microseconds() const { return us_; }
+
+        /// Shifted by a (possibly negative) number of seconds, the way the
+        /// driver gives event time offsets.
+        Timestamp offsetBy(double seconds) const {
+            return Timestamp(us_ +
+                             static_cast<std::int64_t>(
+                                 std::llround(seconds * 1e6)));
+        }
+
+        /// Seconds elapsed from other to this one.
+        double secondsSince(Timestamp const &other) const {
+            return (us_ - other.us_) / 1e6;
+        }
+
+      private:
+        explicit Timestamp(std::int64_t us) : us_(us) {}
+        std::int64_t us_ = 0;
+    };
+
+    /// Maps Timestamps onto the OSVR clock (what osvrTimeValueGetNow()
+    /// reads) using a reading of both clocks taken together. Not thread-safe:
+    /// meant for the thread that sends the reports.
+    class TimestampConverter {
+      public:
+        /// How old the clock reading may get before resyncIfStale() takes a
+        /// new one, so the two clocks can't drift far apart.
+        static const std::int64_t RESYNC_INTERVAL_US = 1000000;
+
+        TimestampConverter() { resync(Timestamp::now()); }
+
+        /// Take a new reading of both clocks if the last one is too old.
+        /// Cheap to call every update.
+        void resyncIfStale() {
+            auto now = Timestamp::now();
+            if (now.microseconds() - anchor_.microseconds() >
+                RESYNC_INTERVAL_US) {
+                resync(now);
+            }
+        }
+
+        OSVR_TimeValue toTimeValue(Timestamp const &t) const {
+            auto us =
+                osvrAnchorUs_ + (t.microseconds() - anchor_.microseconds());
+            OSVR_TimeValue ret;
+            ret.seconds = static_cast<OSVR_TimeValue_Seconds>(us / 1000000);
+            ret.microseconds =
+                static_cast<OSVR_TimeValue_Microseconds>(us % 1000000);
+            if (ret.microseconds < 0) {
+                ret.microseconds += 1000000;
+                ret.seconds -= 1;
+            }
+            return ret;
+        }
+
+      private:
+        void resync(Timestamp const &now) {
+            OSVR_TimeValue tv;
+            osvrTimeValueGetNow(&tv);
+            anchor_ = now;
+            osvrAnchorUs_ = static_cast<std::int64_t>(tv.seconds) * 1000000 +
+                            tv.microseconds;
+        }
+
+        Timestamp anchor_;
+        /// The OSVR clock at anchor_, in microseconds.
+        std::int64_t osvrAnchorUs_ = 0;
+    };
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_Timestamp_h_GUID_4E81C0B9_2F5D_4A67_93C2_A6D1F80B57E4
@@ -0,0 +1,125 @@
+/** @file
+    @brief Microbenchmark comparing Timestamp with the OSVR_TimeValue and
+    std::chrono arithmetic that reports used to be timestamped with.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "Timestamp.h"
+
+// Library/third-party includes
+#include <osvr/Util/TimeValue.h>
+
+// Standard includes
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+using namespace osvr::vive;
+
+static const auto PREFIX = "[ViveTimestampBenchmark] ";
+
+/// The way OSVRViveTracker.cpp used to apply an event time offset.
+template <typename Rep, typename Period>
+static inline osvr::util::time::TimeValue
+addDuration(osvr::util::time::TimeValue const &tv,
+            std::chrono::duration<Rep, Period> additionalTime) {
+    using namespace std::chrono;
+    using SecondsDuration = duration<OSVR_TimeValue_Seconds>;
+    using USecondsDuration = duration<OSVR_TimeValue_Microseconds, std::micro>;
+    auto ret = tv;
+    auto seconds = duration_cast<SecondsDuration>(additionalTime);
+    ret.seconds += seconds.count();
+    ret.microseconds +=
+        duration_cast<USecondsDuration>(additionalTime - seconds).count();
+    osvrTimeValueNormalize(&ret);
+    return ret;
+}
+
+/// Offsets like the driver's: a few milliseconds, either way.
+static inline double offsetFor(std::size_t i) {
+    return static_cast<double>(static_cast<int>(i % 16) - 8) * 0.0005;
+}
+
+/// Keeps the results alive so the loops can't be optimized away.
+static volatile std::int64_t g_sink;
+
+template <typename F>
+static double nanosecondsPer(std::size_t iterations, F &&f) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        f(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           iterations;
+}
+
+static void report(const char *name, double ns) {
+    std::cout << PREFIX << std::setw(40) << std::left << name << std::right
+              << std::fixed << std::setprecision(1) << std::setw(8) << ns
+              << " ns" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::size_t iterations = 10000000;
+    if (argc > 1) {
+        iterations = static_cast<std::size_t>(std::atol(argv[1]));
+    }
+    if (iterations == 0) {
+        std::cerr << "Usage: " << argv[0] << " [iterations]" << std::endl;
+        return 1;
+    }
+    std::cout << PREFIX << iterations << " iterations each" << std::endl;
+
+    /// What each callback does: read the clock and apply its offset.
+    report("Callback, OSVR_TimeValue:",
+           nanosecondsPer(iterations, [](std::size_t i) {
+               auto tv =
+                   addDuration(osvr::util::time::getNow(),
+                               std::chrono::duration<double>(offsetFor(i)));
+               g_sink = tv.microseconds;
+           }));
+    report("Callback, Timestamp:",
+           nanosecondsPer(iterations, [](std::size_t i) {
+               auto t = Timestamp::now().offsetBy(offsetFor(i));
+               g_sink = t.microseconds();
+           }));
+
+    /// What each send adds for Timestamp: the conversion.
+    TimestampConverter converter;
+    auto base = Timestamp::now();
+    report("Send-time conversion of a Timestamp:",
+           nanosecondsPer(iterations, [&](std::size_t i) {
+               auto tv = converter.toTimeValue(base.offsetBy(offsetFor(i)));
+               g_sink = tv.microseconds;
+           }));
+    report("Callback and send, Timestamp:",
+           nanosecondsPer(iterations, [&](std::size_t i) {
+               auto tv = converter.toTimeValue(
+                   Timestamp::now().offsetBy(offsetFor(i)));
+               g_sink = tv.microseconds;
+           }));
+    return 0;
+}
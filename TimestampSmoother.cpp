@@ -0,0 +1,135 @@
+/** @file
+    @brief Implementation
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "TimestampSmoother.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <algorithm>
+#include <cmath>
+
+namespace osvr {
+namespace vive {
+    /// Samples averaged for a first estimate of the period before the filter
+    /// takes over. Passed through as they are in the meantime.
+    static const int ACQUIRE_SAMPLES = 16;
+    /// Filter gains: how much of each residual goes into the phase and the
+    /// period. Small, so jitter averages out over a few dozen samples; beta
+    /// is about alpha^2 / (2 - alpha), for a critically damped response.
+    static const double ALPHA = 0.1;
+    static const double BETA = 0.005;
+    /// Weight of each new residual in the jitter average.
+    static const double JITTER_GAIN = 0.05;
+    /// How fast the lower envelope of the residuals creeps back up after an
+    /// unusually early arrival, per sample, as a fraction of the jitter.
+    static const double FLOOR_RISE = 1. / 32;
+
+    /// Range of periods we'll believe, in microseconds: anything shorter is
+    /// a burst, anything longer a pause in reporting.
+    static const double MIN_PERIOD_US = 100;
+    static const double MAX_PERIOD_US = 100000;
+    /// An arrival at least this many periods late is taken to follow
+    /// samples that never arrived.
+    static const double MISSED_PERIODS = 0.75;
+    /// An arrival off the schedule by more than this many periods - or the
+    /// floor below, whichever is larger - restarts the estimate.
+    static const double RESTART_PERIODS = 4;
+    static const double RESTART_FLOOR_US = 20000;
+
+    Timestamp TimestampSmoother::smooth(Timestamp const &arrival) {
+        auto arrivalUs = static_cast<double>(arrival.microseconds());
+        double outUs = arrivalUs;
+        if (samples_ == 0 || arrivalUs - lastArrivalUs_ > MAX_PERIOD_US) {
+            restart(arrivalUs);
+        } else if (samples_ < ACQUIRE_SAMPLES) {
+            ++samples_;
+            /// Count a long gap as the several periods it likely spans.
+            auto interval = arrivalUs - lastArrivalUs_;
+            periodsSeen_ += periodUs_ > 0
+                                ? std::max(std::floor(interval / periodUs_ +
+                                                      1 - MISSED_PERIODS),
+                                           1.)
+                                : 1.;
+            periodUs_ = (arrivalUs - firstArrivalUs_) / periodsSeen_;
+            estimateUs_ = arrivalUs;
+            if (samples_ == ACQUIRE_SAMPLES && periodUs_ < MIN_PERIOD_US) {
+                restart(arrivalUs);
+            }
+        } else {
+            auto predicted = estimateUs_ + periodUs_;
+            auto residual = arrivalUs - predicted;
+            if (residual > MISSED_PERIODS * periodUs_) {
+                /// Skip over samples that never arrived.
+                auto missed = std::floor(residual / periodUs_ + 0.5);
+                predicted += missed * periodUs_;
+                residual = arrivalUs - predicted;
+            }
+            auto limit =
+                std::max(RESTART_PERIODS * periodUs_, RESTART_FLOOR_US);
+            if (std::abs(residual) > limit) {
+                restart(arrivalUs);
+            } else {
+                estimateUs_ = predicted + ALPHA * residual;
+                periodUs_ =
+                    std::max(periodUs_ + BETA * residual, MIN_PERIOD_US);
+                jitterUs_ += (std::abs(residual) - jitterUs_) * JITTER_GAIN;
+                floorUs_ = std::min(arrivalUs - estimateUs_,
+                                    floorUs_ + FLOOR_RISE * jitterUs_);
+                /// The estimate follows the average delivery delay; the
+                /// arrivals that came soonest after it are the ones closest
+                /// to the actual sampling times. Delivery only ever delays a
+                /// sample, so it can't have been taken after it arrived.
+                outUs = std::min(estimateUs_ + floorUs_, arrivalUs);
+            }
+        }
+        lastArrivalUs_ = arrivalUs;
+
+        auto out = std::max(static_cast<std::int64_t>(std::llround(outUs)),
+                            lastOutputUs_ + 1);
+        lastOutputUs_ = out;
+        return Timestamp::fromMicroseconds(out);
+    }
+
+    double TimestampSmoother::getPeriod() const {
+        return samples_ < ACQUIRE_SAMPLES ? 0. : periodUs_ / 1e6;
+    }
+
+    double TimestampSmoother::getJitter() const { return jitterUs_ / 1e6; }
+
+    void TimestampSmoother::reset() { *this = TimestampSmoother{}; }
+
+    void TimestampSmoother::restart(double arrivalUs) {
+        samples_ = 1;
+        firstArrivalUs_ = arrivalUs;
+        periodsSeen_ = 0;
+        estimateUs_ = arrivalUs;
+        periodUs_ = 0;
+        floorUs_ = 0;
+    }
+
+} // namespace vive
+} // namespace osvr
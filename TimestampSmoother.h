@@ -0,0 +1,93 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_TimestampSmoother_h_GUID_A3C5E0F8_71B2_4D9E_8C46_5F2B9D1E07A3
+#define INCLUDED_TimestampSmoother_h_GUID_A3C5E0F8_71B2_4D9E_8C46_5F2B9D1E07A3
+
+// Internal Includes
+#include "Timestamp.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cstdint>
+
+namespace osvr {
+namespace vive {
+
+    /// Takes the timestamps a device's poses are stamped with on arrival -
+    /// sampling time plus however long the driver and its thread took to
+    /// deliver them - and estimates when they were actually sampled.
+    ///
+    /// Poses are sampled on a steady schedule, so an alpha-beta filter tracks
+    /// that schedule (phase and period), and since delivery can only ever
+    /// add delay, its estimate is never allowed to be later than an arrival.
+    /// The output is strictly increasing, and follows the sampling schedule
+    /// rather than the jitter in delivering it, so downstream prediction and
+    /// filtering see consistent time deltas.
+    ///
+    /// Dropped samples are skipped over; anything too far off the schedule
+    /// to be jitter (a stall, or a change in rate) restarts the estimate.
+    /// Not thread-safe: one per device, on the thread that sends poses.
+    class TimestampSmoother {
+      public:
+        /// @param arrival the report's arrival time, with the driver's own
+        /// time offset already applied.
+        /// @return the smoothed timestamp to send.
+        Timestamp smooth(Timestamp const &arrival);
+
+        /// Estimated sampling period in seconds, or 0 if not yet known.
+        double getPeriod() const;
+
+        /// Running average of how far arrivals stray from the estimated
+        /// schedule, in seconds.
+        double getJitter() const;
+
+        /// Forget everything, as for a device that's reconnected.
+        void reset();
+
+      private:
+        /// Start over from this arrival.
+        void restart(double arrivalUs);
+        /// Samples seen since the last restart, while still averaging them
+        /// for a first estimate of the period.
+        int samples_ = 0;
+        double firstArrivalUs_ = 0;
+        double periodsSeen_ = 0;
+        /// Estimated sampling time of the last sample, in microseconds.
+        double estimateUs_ = 0;
+        double periodUs_ = 0;
+        double jitterUs_ = 0;
+        /// Lower envelope of how far arrivals land from the estimate.
+        double floorUs_ = 0;
+        double lastArrivalUs_ = 0;
+        /// Last timestamp handed out, to keep them strictly increasing.
+        std::int64_t lastOutputUs_ = 0;
+    };
+
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_TimestampSmoother_h_GUID_A3C5E0F8_71B2_4D9E_8C46_5F2B9D1E07A3
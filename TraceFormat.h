@@ -0,0 +1,203 @@
+/** @file
+    @brief Header describing the binary format of recorded driver callback
+    traces.
+
+    A trace is a FileHeader followed by records, each a RecordHeader then
+    payloadSize bytes of payload. Everything is in native byte order and
+    layout, and poses are stored as raw vr::DriverPose_t, so traces are meant
+    to be read back on the same platform (and build of openvr_driver.h) they
+    were recorded on - the header records enough to check that.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_TraceFormat_h_GUID_A5C7E913_0B2D_4F6E_8C39_D1F4A6B28E07
+#define INCLUDED_TraceFormat_h_GUID_A5C7E913_0B2D_4F6E_8C39_D1F4A6B28E07
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+#include <openvr_driver.h>
+
+// Standard includes
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace osvr {
+namespace vive {
+    namespace trace {
+
+        static const char MAGIC[8] = {'O', 'S', 'V', 'R', 'V', 'T', 'R', 'C'};
+        static const std::uint32_t FORMAT_VERSION = 1;
+
+        struct FileHeader {
+            char magic[8];
+            std::uint32_t version;
+            /// sizeof(vr::DriverPose_t) when recorded.
+            std::uint32_t poseSize;
+        };
+
+        inline FileHeader makeFileHeader() {
+            FileHeader ret;
+            std::memcpy(ret.magic, MAGIC, sizeof(MAGIC));
+            ret.version = FORMAT_VERSION;
+            ret.poseSize = sizeof(vr::DriverPose_t);
+            return ret;
+        }
+
+        /// @return true if the header is one we can read.
+        inline bool isCompatible(FileHeader const &header) {
+            return 0 == std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) &&
+                   FORMAT_VERSION == header.version &&
+                   sizeof(vr::DriverPose_t) == header.poseSize;
+        }
+
+        /// One per ServerDriverHost callback we record.
+        enum class RecordType : std::uint8_t {
+            /// Payload: vr::DriverPose_t
+            Pose = 1,
+            /// Payload: ButtonPayload
+            ButtonPressed,
+            ButtonUnpressed,
+            ButtonTouched,
+            ButtonUntouched,
+            /// Payload: AxisPayload
+            Axis,
+            /// Payload: IpdPayload
+            Ipd,
+            /// Payload: ProximityPayload
+            Proximity,
+            /// No payload
+            PropertiesChanged,
+            /// Payload: DeviceAddedPayload, with the serial number truncated
+            /// to its actual length. The device field is the sensor ID it
+            /// was assigned.
+            DeviceAdded,
+            /// Payload: VendorEventPayload
+            VendorEvent,
+            /// No payload. Written first by each recorder that opens the file:
+            /// the monotonic clock's epoch may differ from the session before.
+            SessionStart
+        };
+
+        struct RecordHeader {
+            /// Nanoseconds on a monotonic clock with an arbitrary epoch -
+            /// only differences between records of the same session are
+            /// meaningful.
+            std::uint64_t timestamp;
+            std::uint32_t device;
+            RecordType type;
+            std::uint8_t reserved;
+            std::uint16_t payloadSize;
+        };
+
+        struct ButtonPayload {
+            std::uint32_t button;
+            std::uint32_t reserved;
+            double eventTimeOffset;
+        };
+
+        struct AxisPayload {
+            std::uint32_t axis;
+            float x;
+            float y;
+        };
+
+        struct IpdPayload {
+            float meters;
+        };
+
+        struct ProximityPayload {
+            std::uint8_t triggered;
+        };
+
+        static const std::size_t MAX_SERIAL_LENGTH = 63;
+        struct DeviceAddedPayload {
+            /// A DeviceRole value.
+            std::uint8_t role;
+            char serial[MAX_SERIAL_LENGTH];
+        };
+
+        struct VendorEventPayload {
+            std::uint32_t eventType;
+            std::uint32_t reserved;
+            double eventTimeOffset;
+        };
+
+        /// Big enough for any payload: poses are the largest by far.
+        static const std::size_t MAX_PAYLOAD_SIZE = sizeof(vr::DriverPose_t);
+        static_assert(sizeof(DeviceAddedPayload) <= MAX_PAYLOAD_SIZE,
+                      "Pose should be the largest payload");
+
+        /// A record in memory: header plus room for the largest payload.
+        struct Record {
+            RecordHeader header;
+            unsigned char payload[MAX_PAYLOAD_SIZE];
+
+            /// Copy in a fixed-size payload.
+            template <typename T> void setPayload(T const &p) {
+                static_assert(sizeof(T) <= MAX_PAYLOAD_SIZE,
+                              "Payload too large");
+                std::memcpy(payload, &p, sizeof(T));
+                header.payloadSize = static_cast<std::uint16_t>(sizeof(T));
+            }
+
+            /// Copy out a fixed-size payload.
+            /// @return false if the record's payload is the wrong size.
+            template <typename T> bool getPayload(T &p) const {
+                if (header.payloadSize != sizeof(T)) {
+                    return false;
+                }
+                std::memcpy(&p, payload, sizeof(T));
+                return true;
+            }
+        };
+
+        inline bool writeRecord(std::ostream &os, Record const &rec) {
+            os.write(reinterpret_cast<const char *>(&rec.header),
+                     sizeof(rec.header));
+            os.write(reinterpret_cast<const char *>(rec.payload),
+                     rec.header.payloadSize);
+            return static_cast<bool>(os);
+        }
+
+        /// @return false at end of file, or on a truncated or corrupt record.
+        inline bool readRecord(std::istream &is, Record &rec) {
+            if (!is.read(reinterpret_cast<char *>(&rec.header),
+                         sizeof(rec.header))) {
+                return false;
+            }
+            if (rec.header.payloadSize > MAX_PAYLOAD_SIZE) {
+                return false;
+            }
+            return static_cast<bool>(
+                is.read(reinterpret_cast<char *>(rec.payload),
+                        rec.header.payloadSize));
+        }
+
+    } // namespace trace
+} // namespace vive
+} // namespace osvr
+
+#endif // INCLUDED_TraceFormat_h_GUID_A5C7E913_0B2D_4F6E_8C39_D1F4A6B28E07
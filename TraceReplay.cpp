@@ -0,0 +1,353 @@
+/** @file
+    @brief Tool to replay a recorded driver callback trace through
+    ViveDriverHost, with no driver or OSVR server, to measure the throughput
+    and latency of its queueing and conversion.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Razer Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "Logger.h"
+#include "OSVRViveTracker.h"
+#include "StubPluginKit.h"
+#include "TraceFormat.h"
+
+// Library/third-party includes
+#include <openvr_driver.h>
+
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace osvr::vive;
+
+static const auto PREFIX = "[ViveTraceReplay] ";
+
+struct Options {
+    std::string traceFile;
+    /// Multiple of the recorded rate; 0 for as fast as possible.
+    double speed = 1.;
+    /// How long the main loop sleeps between updates, like the server's.
+    std::chrono::microseconds updateInterval{1000};
+};
+
+static void usage(const char *argv0) {
+    std::cerr
+        << "Usage: " << argv0
+        << " [--speed <factor> | --fast] [--update-interval <microseconds>] "
+           "<trace file>\n\n"
+           "Replays a trace recorded with the callbackTraceFile option\n"
+           "through the plugin's callback handling, with OSVR stubbed out.\n"
+           "  --speed <factor>   Replay at this multiple of the recorded "
+           "rate (default 1)\n"
+           "  --fast             Replay as fast as possible\n"
+           "  --update-interval  Sleep between main-loop updates (default "
+           "1000)\n"
+        << std::endl;
+}
+
+static bool parseArgs(int argc, char *argv[], Options &opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool haveValue = i + 1 < argc;
+        if (arg == "--fast") {
+            opts.speed = 0;
+        } else if (arg == "--speed" && haveValue) {
+            opts.speed = std::atof(argv[++i]);
+            if (!(opts.speed > 0)) {
+                std::cerr << PREFIX << "Speed must be positive." << std::endl;
+                return false;
+            }
+        } else if (arg == "--update-interval" && haveValue) {
+            opts.updateInterval =
+                std::chrono::microseconds(std::atoi(argv[++i]));
+        } else if (!arg.empty() && arg[0] != '-' && opts.traceFile.empty()) {
+            opts.traceFile = arg;
+        } else {
+            return false;
+        }
+    }
+    return !opts.traceFile.empty();
+}
+
+/// Load the whole trace up front, so file I/O doesn't disturb the timing.
+static bool loadTrace(std::string const &fn,
+                      std::vector<trace::Record> &records) {
+    std::ifstream is(fn, std::ios::in | std::ios::binary);
+    if (!is) {
+        std::cerr << PREFIX << "Could not open " << fn << std::endl;
+        return false;
+    }
+    trace::FileHeader header;
+    if (!is.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        !trace::isCompatible(header)) {
+        std::cerr << PREFIX << fn
+                  << " is not a callback trace this build can read."
+                  << std::endl;
+        return false;
+    }
+    trace::Record rec;
+    while (trace::readRecord(is, rec)) {
+        records.push_back(rec);
+    }
+    if (!is.eof()) {
+        std::cerr << PREFIX << "Stopped reading at a truncated or corrupt "
+                               "record, replaying what came before it."
+                  << std::endl;
+    }
+    return true;
+}
+
+/// Each recording session in a trace counts time from its own epoch, so lay
+/// the sessions end to end.
+/// @return each record's offset from the start of the replay, in nanoseconds.
+static std::vector<std::uint64_t>
+computeReplayOffsets(std::vector<trace::Record> const &records) {
+    std::vector<std::uint64_t> offsets;
+    offsets.reserve(records.size());
+    std::uint64_t base = records.front().header.timestamp;
+    std::uint64_t sessionOffset = 0;
+    for (auto const &rec : records) {
+        if (rec.header.type == trace::RecordType::SessionStart) {
+            base = rec.header.timestamp;
+            sessionOffset = offsets.empty() ? 0 : offsets.back();
+        }
+        /// Driver threads can race to the ring, so a record may be stamped
+        /// a little before the one queued ahead of it.
+        auto stamp = std::max(rec.header.timestamp, base);
+        offsets.push_back(sessionOffset + (stamp - base));
+    }
+    return offsets;
+}
+
+/// Make the callback a record describes.
+static void replayRecord(ViveDriverHost &host, trace::Record const &rec) {
+    auto dev = rec.header.device;
+    switch (rec.header.type) {
+    case trace::RecordType::Pose: {
+        vr::DriverPose_t pose;
+        if (rec.getPayload(pose)) {
+            host.TrackedDevicePoseUpdated(dev, pose);
+        }
+        break;
+    }
+    case trace::RecordType::ButtonPressed:
+    case trace::RecordType::ButtonUnpressed:
+    case trace::RecordType::ButtonTouched:
+    case trace::RecordType::ButtonUntouched: {
+        trace::ButtonPayload p;
+        if (!rec.getPayload(p)) {
+            break;
+        }
+        auto button = static_cast<vr::EVRButtonId>(p.button);
+        switch (rec.header.type) {
+        case trace::RecordType::ButtonPressed:
+            host.TrackedDeviceButtonPressed(dev, button, p.eventTimeOffset);
+            break;
+        case trace::RecordType::ButtonUnpressed:
+            host.TrackedDeviceButtonUnpressed(dev, button, p.eventTimeOffset);
+            break;
+        case trace::RecordType::ButtonTouched:
+            host.TrackedDeviceButtonTouched(dev, button, p.eventTimeOffset);
+            break;
+        default:
+            host.TrackedDeviceButtonUntouched(dev, button, p.eventTimeOffset);
+            break;
+        }
+        break;
+    }
+    case trace::RecordType::Axis: {
+        trace::AxisPayload p;
+        if (rec.getPayload(p)) {
+            vr::VRControllerAxis_t state;
+            state.x = p.x;
+            state.y = p.y;
+            host.TrackedDeviceAxisUpdated(dev, p.axis, state);
+        }
+        break;
+    }
+    case trace::RecordType::Ipd: {
+        trace::IpdPayload p;
+        if (rec.getPayload(p)) {
+            host.PhysicalIpdSet(dev, p.meters);
+        }
+        break;
+    }
+    case trace::RecordType::Proximity: {
+        trace::ProximityPayload p;
+        if (rec.getPayload(p)) {
+            host.ProximitySensorState(dev, p.triggered != 0);
+        }
+        break;
+    }
+    case trace::RecordType::PropertiesChanged:
+        host.TrackedDevicePropertiesChanged(dev);
+        break;
+    case trace::RecordType::DeviceAdded: {
+        /// Variable length: the serial number is only as long as it is.
+        static const auto serialOffset =
+            offsetof(trace::DeviceAddedPayload, serial);
+        auto size = rec.header.payloadSize;
+        if (size < serialOffset || size > sizeof(trace::DeviceAddedPayload)) {
+            break;
+        }
+        trace::DeviceAddedPayload p;
+        std::memcpy(&p, rec.payload, size);
+        if (p.role > static_cast<std::uint8_t>(DeviceRole::Other)) {
+            break;
+        }
+        host.activateReplayedDevice(dev, static_cast<DeviceRole>(p.role),
+                                    std::string(p.serial, size - serialOffset));
+        break;
+    }
+    case trace::RecordType::VendorEvent: {
+        trace::VendorEventPayload p;
+        if (rec.getPayload(p)) {
+            vr::VREvent_Data_t data;
+            std::memset(&data, 0, sizeof(data));
+            host.VendorSpecificEvent(
+                dev, static_cast<vr::EVREventType>(p.eventType), data,
+                p.eventTimeOffset);
+        }
+        break;
+    }
+    case trace::RecordType::SessionStart:
+        /// Only affects the timing, handled by computeReplayOffsets().
+        break;
+    default:
+        /// From a newer recorder, perhaps: skip it.
+        break;
+    }
+}
+
+static void printStats(const char *name, stub_pluginkit::SendType type,
+                       double seconds) {
+    auto const &stats = stub_pluginkit::getStats(type);
+    std::cout << PREFIX << std::setw(8) << name << ": " << stats.count
+              << " sent (" << std::fixed << std::setprecision(0)
+              << stats.count / seconds << "/s)";
+    if (!stats.latencies.empty()) {
+        auto latencies = stats.latencies;
+        std::sort(latencies.begin(), latencies.end());
+        auto at = [&](double fraction) {
+            auto i = static_cast<std::size_t>(fraction *
+                                              (latencies.size() - 1));
+            return latencies[i] * 1e6;
+        };
+        std::cout << std::setprecision(0)
+                  << ", report to send in microseconds: min " << at(0)
+                  << ", median " << at(0.5) << ", 99% " << at(0.99)
+                  << ", max " << at(1);
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        usage(argv[0]);
+        return 1;
+    }
+    std::vector<trace::Record> records;
+    if (!loadTrace(opts.traceFile, records)) {
+        return 1;
+    }
+    if (records.empty()) {
+        std::cerr << PREFIX << "Trace is empty." << std::endl;
+        return 1;
+    }
+    const auto offsets = computeReplayOffsets(records);
+    const auto recordedSeconds = offsets.back() / 1e9;
+    std::cout << PREFIX << "Loaded " << records.size() << " records covering "
+              << recordedSeconds << " seconds" << std::endl;
+
+    PluginConfig config;
+    /// The devices are made up: don't remember their sensor IDs in a file.
+    config.sensorIdMapFile.clear();
+    DriverHostPtr host(new ViveDriverHost);
+    host->startWithoutDriver(config);
+    host->registerDevice(stub_pluginkit::getContext());
+    stub_pluginkit::resetStats();
+
+    /// The records play the part of the driver's tracking thread, while
+    /// this thread plays the server's main loop.
+    std::atomic<bool> replayDone{false};
+    std::chrono::steady_clock::duration maxLag{0};
+    auto start = std::chrono::steady_clock::now();
+    std::thread replayThread([&] {
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            if (opts.speed > 0) {
+                auto offset = std::chrono::duration<double, std::nano>(
+                    offsets[i] / opts.speed);
+                auto due =
+                    start +
+                    std::chrono::duration_cast<
+                        std::chrono::steady_clock::duration>(offset);
+                std::this_thread::sleep_until(due);
+                maxLag =
+                    std::max(maxLag, std::chrono::steady_clock::now() - due);
+            }
+            replayRecord(*host, records[i]);
+        }
+        replayDone = true;
+    });
+
+    while (!replayDone) {
+        stub_pluginkit::runUpdate();
+        if (opts.updateInterval.count() > 0) {
+            std::this_thread::sleep_for(opts.updateInterval);
+        }
+    }
+    replayThread.join();
+    /// Once for the last reports, once more for anything they triggered.
+    stub_pluginkit::runUpdate();
+    stub_pluginkit::runUpdate();
+    auto seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    /// Get the plugin's own messages out of the way of the results.
+    Logger::instance().flush();
+
+    std::cout << PREFIX << "Replayed " << records.size() << " records in "
+              << seconds << " seconds (" << std::fixed << std::setprecision(0)
+              << records.size() / seconds << " records/s)" << std::endl;
+    if (opts.speed > 0) {
+        std::cout << PREFIX << "Fell at most "
+                  << std::chrono::duration<double, std::micro>(maxLag).count()
+                  << " microseconds behind the recorded timing" << std::endl;
+    }
+    printStats("Poses", stub_pluginkit::SendType::Pose, seconds);
+    printStats("Buttons", stub_pluginkit::SendType::Button, seconds);
+    printStats("Analogs", stub_pluginkit::SendType::Analog, seconds);
+    std::cout << PREFIX << "Descriptors sent: "
+              << stub_pluginkit::getDescriptorCount() << std::endl;
+    return 0;
+}
@@ -23,98 +23,477 @@
 // limitations under the License.
 
 // Internal Includes
+#include "Logger.h"
+#include "ThreadTuning.h"
 
 // Library/third-party includes
 #include <VRSettings.h>
+#include <json/reader.h>
+#include <json/value.h>
+#include <json/writer.h>
 
 // Standard includes
-#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
 
 using namespace vr;
 
-#ifdef DISABLE_LOG_EVENTS
-#define LOG_EVENTS(X)                                                          \
-    do {                                                                       \
-    } while (0)
+#define LOG_EVENTS(X) OSVR_VIVE_LOG_DEBUG(X)
+
+static const auto SETTINGS_FILENAME = "steamvr.vrsettings";
+#ifdef _WIN32
+static const auto PATH_SEPARATOR = "\\";
+#else
+static const auto PATH_SEPARATOR = "/";
+#endif
+
+/// Initial number of hash table slots: a power of two.
+static const std::size_t INITIAL_CAPACITY = 64;
+
+/// How long after a change to wait for more before writing them all out.
+static const auto WRITE_DELAY = std::chrono::milliseconds(500);
+
+/// FNV-1a over the section and key, with a separator that can't appear in
+/// either.
+static inline std::uint32_t hashKey(const char *section, const char *key) {
+    std::uint32_t hash = 2166136261u;
+    auto mix = [&hash](const char *s) {
+        for (; *s; ++s) {
+            hash ^= static_cast<unsigned char>(*s);
+            hash *= 16777619u;
+        }
+    };
+    mix(section);
+    hash ^= 0xffu;
+    hash *= 16777619u;
+    mix(key);
+    return hash;
+}
+
+static inline void setError(EVRSettingsError *peError, EVRSettingsError err) {
+    if (peError) {
+        *peError = err;
+    }
+}
+
+/// Move the temporary file over the destination in one step, so SteamVR
+/// (and a crash mid-write) only ever sees a complete file.
+static inline bool replaceFile(std::string const &tmp,
+                               std::string const &dest) {
+#ifdef _WIN32
+    return 0 != MoveFileExA(tmp.c_str(), dest.c_str(),
+                            MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
 #else
-#define LOG_EVENTS(X)                                                          \
-    do {                                                                       \
-        std::cout << X << std::endl;                                           \
-    } while (0)
+    return 0 == std::rename(tmp.c_str(), dest.c_str());
 #endif
+}
+
+VRSettings::VRSettings()
+    : entries_(INITIAL_CAPACITY), root_(new Json::Value(Json::objectValue)) {}
+
+VRSettings::~VRSettings() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+std::string VRSettings::getSettingsFile(std::string const &rootConfigDir) {
+    return rootConfigDir + PATH_SEPARATOR + SETTINGS_FILENAME;
+}
+
+bool VRSettings::load(std::string const &fn) {
+    Json::Value root;
+    bool parsed = false;
+    {
+        std::ifstream is(fn);
+        Json::Reader reader;
+        if (!is) {
+            osvr::vive::logWarn() << "No SteamVR settings found at " << fn
+                                  << ", starting with none and keeping "
+                                     "changes in memory only.";
+        } else if (!reader.parse(is, root) || !root.isObject()) {
+            osvr::vive::logWarn() << "Could not parse SteamVR settings at "
+                                  << fn
+                                  << ", starting with none and keeping "
+                                     "changes in memory only: "
+                                  << reader.getFormattedErrorMessages();
+        } else {
+            parsed = true;
+        }
+    }
+    if (!parsed) {
+        root = Json::Value(Json::objectValue);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    /// Writing back what little we'd have would clobber a file we couldn't
+    /// read.
+    if (parsed) {
+        filename_ = fn;
+    } else {
+        filename_.clear();
+    }
+    entries_.assign(INITIAL_CAPACITY, Entry{});
+    used_ = 0;
+    *root_ = root;
+    /// Index the simple values; anything else just rides along in root_.
+    for (auto const &section : root.getMemberNames()) {
+        auto const &members = root[section];
+        if (!members.isObject()) {
+            continue;
+        }
+        for (auto const &key : members.getMemberNames()) {
+            auto const &val = members[key];
+            if (val.isBool()) {
+                auto &entry = insert(section.c_str(), key.c_str());
+                entry.type = ValueType::Bool;
+                entry.number = val.asBool() ? 1. : 0.;
+            } else if (val.isNumeric()) {
+                auto &entry = insert(section.c_str(), key.c_str());
+                entry.type = ValueType::Number;
+                entry.number = val.asDouble();
+            } else if (val.isString()) {
+                auto &entry = insert(section.c_str(), key.c_str());
+                entry.type = ValueType::String;
+                entry.string = val.asString();
+            }
+        }
+    }
+    return parsed;
+}
+
+VRSettings::Entry const *VRSettings::find(const char *section,
+                                          const char *key) const {
+    auto hash = hashKey(section, key);
+    auto mask = entries_.size() - 1;
+    for (auto i = hash & mask;; i = (i + 1) & mask) {
+        auto const &entry = entries_[i];
+        if (ValueType::Empty == entry.type) {
+            return nullptr;
+        }
+        if (ValueType::Removed != entry.type && entry.hash == hash &&
+            entry.section == section && entry.key == key) {
+            return &entry;
+        }
+    }
+}
+
+VRSettings::Entry &VRSettings::insert(const char *section, const char *key) {
+    if (auto existing = find(section, key)) {
+        return const_cast<Entry &>(*existing);
+    }
+    /// Keep at least a quarter of the slots empty, so probes stay short.
+    if ((used_ + 1) * 4 > entries_.size() * 3) {
+        rehash(entries_.size() * 2);
+    }
+    auto hash = hashKey(section, key);
+    auto mask = entries_.size() - 1;
+    auto i = hash & mask;
+    while (ValueType::Empty != entries_[i].type) {
+        i = (i + 1) & mask;
+    }
+    auto &entry = entries_[i];
+    entry.hash = hash;
+    entry.section = section;
+    entry.key = key;
+    ++used_;
+    return entry;
+}
+
+void VRSettings::rehash(std::size_t capacity) {
+    std::vector<Entry> old(capacity);
+    old.swap(entries_);
+    used_ = 0;
+    auto mask = entries_.size() - 1;
+    for (auto &entry : old) {
+        if (ValueType::Empty == entry.type ||
+            ValueType::Removed == entry.type) {
+            continue;
+        }
+        auto i = entry.hash & mask;
+        while (ValueType::Empty != entries_[i].type) {
+            i = (i + 1) & mask;
+        }
+        entries_[i] = std::move(entry);
+        ++used_;
+    }
+}
+
+void VRSettings::markDirty() {
+    if (filename_.empty()) {
+        return;
+    }
+    dirty_ = true;
+    if (!writer_.joinable()) {
+        writer_ = std::thread([this] { writerThread(); });
+    }
+    wake_.notify_all();
+}
+
+void VRSettings::writerThread() {
+    osvr::vive::OwnedThread thread("vive-settings");
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [&] { return dirty_ || stopping_; });
+        if (!stopping_ && !syncRequested_) {
+            /// Give a burst of changes a moment to finish.
+            wake_.wait_for(lock, WRITE_DELAY,
+                           [&] { return stopping_ || syncRequested_; });
+        }
+        if (dirty_) {
+            Json::Value snapshot = *root_;
+            dirty_ = false;
+            syncRequested_ = false;
+            lock.unlock();
+            write(snapshot);
+            lock.lock();
+        }
+        if (stopping_ && !dirty_) {
+            break;
+        }
+    }
+}
+
+void VRSettings::write(Json::Value const &root) {
+    std::string fn;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fn = filename_;
+    }
+    auto tmp = fn + ".tmp";
+    {
+        std::ofstream os(tmp, std::ios::out | std::ios::trunc);
+        if (!os) {
+            osvr::vive::logWarn() << "Could not open " << tmp
+                                  << " to save SteamVR settings.";
+            return;
+        }
+        os << Json::StyledWriter().write(root);
+        if (!os.flush()) {
+            osvr::vive::logWarn() << "Could not write SteamVR settings to "
+                                  << tmp;
+            return;
+        }
+    }
+    if (!replaceFile(tmp, fn)) {
+        std::remove(tmp.c_str());
+        osvr::vive::logWarn() << "Could not replace " << fn
+                              << " with updated SteamVR settings.";
+    }
+}
 
 const char *VRSettings::GetSettingsErrorNameFromEnum(EVRSettingsError eError) {
-    LOG_EVENTS("GetSettingsErrorNameFromEnum(" << eError << ")");
-    return "Error";
+    switch (eError) {
+    case VRSettingsError_None:
+        return "VRSettingsError_None";
+    case VRSettingsError_IPCFailed:
+        return "VRSettingsError_IPCFailed";
+    case VRSettingsError_WriteFailed:
+        return "VRSettingsError_WriteFailed";
+    case VRSettingsError_ReadFailed:
+        return "VRSettingsError_ReadFailed";
+    default:
+        return "Unknown settings error";
+    }
 }
 
 bool VRSettings::Sync(bool bForce, EVRSettingsError *peError) {
-    LOG_EVENTS("Sync(" << bForce << ", " << peError << ")");
-    // retur true for now
+    LOG_EVENTS("Sync(" << bForce << ")");
+    setError(peError, VRSettingsError_None);
+    std::lock_guard<std::mutex> lock(mutex_);
+    /// Forced or not, the file already matches unless something changed.
+    if (!dirty_) {
+        return false;
+    }
+    syncRequested_ = true;
+    wake_.notify_all();
     return true;
 }
 
 bool VRSettings::GetBool(const char *pchSection, const char *pchSettingsKey,
                          bool bDefaultValue, EVRSettingsError *peError) {
-    LOG_EVENTS("GetBool(" << pchSection << ", " << pchSettingsKey << ", "
-                          << bDefaultValue << ", " << peError << ")");
-    // return true for now
-    return true;
+    setError(peError, VRSettingsError_None);
+    if (!pchSection || !pchSettingsKey) {
+        return bDefaultValue;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = find(pchSection, pchSettingsKey);
+    if (!entry || ValueType::String == entry->type) {
+        return bDefaultValue;
+    }
+    return entry->number != 0.;
 }
+
 void VRSettings::SetBool(const char *pchSection, const char *pchSettingsKey,
                          bool bValue, EVRSettingsError *peError) {
+    setError(peError, VRSettingsError_None);
+    if (!pchSection || !pchSettingsKey) {
+        return;
+    }
     LOG_EVENTS("SetBool(" << pchSection << ", " << pchSettingsKey << ", "
-                          << bValue << ", " << peError << ")");
+                          << bValue << ")");
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &entry = insert(pchSection, pchSettingsKey);
+    entry.type = ValueType::Bool;
+    entry.number = bValue ? 1. : 0.;
+    (*root_)[pchSection][pchSettingsKey] = bValue;
+    markDirty();
 }
 
 int32_t VRSettings::GetInt32(const char *pchSection, const char *pchSettingsKey,
                              int32_t nDefaultValue, EVRSettingsError *peError) {
-    LOG_EVENTS("SetBool(" << pchSection << ", " << pchSettingsKey << ", "
-                          << nDefaultValue << ", " << peError << ")");
-    // return non-existing value for now
-    return 67;
+    setError(peError, VRSettingsError_None);
+    if (!pchSection || !pchSettingsKey) {
+        return nDefaultValue;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = find(pchSection, pchSettingsKey);
+    if (!entry || ValueType::String == entry->type) {
+        return nDefaultValue;
+    }
+    return static_cast<int32_t>(entry->number);
 }
+
 void VRSettings::SetInt32(const char *pchSection, const char *pchSettingsKey,
                           int32_t nValue, EVRSettingsError *peError) {
+    setError(peError, VRSettingsError_None);
+    if (!pchSection || !pchSettingsKey) {
+        return;
+    }
     LOG_EVENTS("SetInt32(" << pchSection << ", " << pchSettingsKey << ", "
-                           << nValue << ", " << peError << ")");
+                           << nValue << ")");
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &entry = insert(pchSection, pchSettingsKey);
+    entry.type = ValueType::Number;
+    entry.number = nValue;
+    (*root_)[pchSection][pchSettingsKey] = nValue;
+    markDirty();
 }
 
 float VRSettings::GetFloat(const char *pchSection, const char *pchSettingsKey,
                            float flDefaultValue, EVRSettingsError *peError) {
-    LOG_EVENTS("SetInt32(" << pchSection << ", " << pchSettingsKey << ", "
-                           << flDefaultValue << ", " << peError << ")");
-    return 67.0;
+    setError(peError, VRSettingsError_None);
+    if (!pchSection || !pchSettingsKey) {
+        return flDefaultValue;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = find(pchSection, pchSettingsKey);
+    if (!entry || ValueType::String == entry->type) {
+        return flDefaultValue;
+    }
+    return static_cast<float>(entry->number);
 }
 
 void VRSettings::SetFloat(const char *pchSection, const char *pchSettingsKey,
                           float flValue, EVRSettingsError *peError) {
-    LOG_EVENTS("SetInt32(" << pchSection << ", " << pchSettingsKey << ", "
-                           << flValue << ", " << peError << ")");
+    setError(peError, VRSettingsError_None);
+    if (!pchSection || !pchSettingsKey) {
+        return;
+    }
+    LOG_EVENTS("SetFloat(" << pchSection << ", " << pchSettingsKey << ", "
+                           << flValue << ")");
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &entry = insert(pchSection, pchSettingsKey);
+    entry.type = ValueType::Number;
+    entry.number = flValue;
+    (*root_)[pchSection][pchSettingsKey] = flValue;
+    markDirty();
 }
 
-void GetString(const char *pchSection, const char *pchSettingsKey,
-               char *pchValue, uint32_t unValueLen, const char *pchDefaultValue,
-               EVRSettingsError *peError) {
-    LOG_EVENTS("SetInt32(" << pchSection << ", " << pchSettingsKey << ", "
-                           << unValueLen << ", " << pchDefaultValue << ", "
-                           << peError << ")");
+void VRSettings::GetString(const char *pchSection, const char *pchSettingsKey,
+                           char *pchValue, uint32_t unValueLen,
+                           const char *pchDefaultValue,
+                           EVRSettingsError *peError) {
+    setError(peError, VRSettingsError_None);
+    if (!pchValue || 0 == unValueLen) {
+        return;
+    }
+    const char *src = pchDefaultValue ? pchDefaultValue : "";
+    std::size_t len = std::strlen(src);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = pchSection && pchSettingsKey
+                     ? find(pchSection, pchSettingsKey)
+                     : nullptr;
+    if (entry && ValueType::String == entry->type) {
+        src = entry->string.c_str();
+        len = entry->string.size();
+    }
+    /// Truncate to fit, always terminating.
+    len = std::min<std::size_t>(len, unValueLen - 1);
+    std::memcpy(pchValue, src, len);
+    pchValue[len] = '\0';
 }
 
 void VRSettings::SetString(const char *pchSection, const char *pchSettingsKey,
                            const char *pchValue, EVRSettingsError *peError) {
-    LOG_EVENTS("SetInt32(" << pchSection << ", " << pchSettingsKey << ", "
-                           << pchValue << ", " << peError << ")");
+    setError(peError, VRSettingsError_None);
+    if (!pchSection || !pchSettingsKey || !pchValue) {
+        return;
+    }
+    LOG_EVENTS("SetString(" << pchSection << ", " << pchSettingsKey << ", "
+                            << pchValue << ")");
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &entry = insert(pchSection, pchSettingsKey);
+    entry.type = ValueType::String;
+    entry.string = pchValue;
+    (*root_)[pchSection][pchSettingsKey] = pchValue;
+    markDirty();
 }
 
 void VRSettings::RemoveSection(const char *pchSection,
                                EVRSettingsError *peError) {
-    LOG_EVENTS("SetInt32(" << pchSection << ", " << peError << ")");
+    setError(peError, VRSettingsError_None);
+    if (!pchSection) {
+        return;
+    }
+    LOG_EVENTS("RemoveSection(" << pchSection << ")");
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &entry : entries_) {
+        if (ValueType::Empty != entry.type && entry.section == pchSection) {
+            entry.type = ValueType::Removed;
+        }
+    }
+    if (root_->isMember(pchSection)) {
+        root_->removeMember(pchSection);
+        markDirty();
+    }
 }
 
 void VRSettings::RemoveKeyInSection(const char *pchSection,
                                     const char *pchSettingsKey,
                                     EVRSettingsError *peError) {
-    LOG_EVENTS("SetInt32(" << pchSection << ", " << pchSettingsKey << ", "
-                           << peError << ")");
+    setError(peError, VRSettingsError_None);
+    if (!pchSection || !pchSettingsKey) {
+        return;
+    }
+    LOG_EVENTS("RemoveKeyInSection(" << pchSection << ", " << pchSettingsKey
+                                     << ")");
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto entry = find(pchSection, pchSettingsKey)) {
+        const_cast<Entry &>(*entry).type = ValueType::Removed;
+    }
+    /// Indexing a missing section would add it, as a null.
+    if (!root_->isMember(pchSection)) {
+        return;
+    }
+    auto &section = (*root_)[pchSection];
+    if (section.isObject() && section.isMember(pchSettingsKey)) {
+        section.removeMember(pchSettingsKey);
+        markDirty();
+    }
 }
@@ -26,21 +26,60 @@
 #define INCLUDED_VRSettings_h_GUID_138FAF71_763D_4499_62A1_BBD01F8F2567
 
 // Internal Includes
+// - none
 
 // Library/third-party includes
 #include <openvr_driver.h>
 
 // Standard includes
-// - none
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Json {
+class Value;
+} // namespace Json
 
 using namespace vr;
 
+/// The settings the driver reads (and occasionally writes) through
+/// IVRSettings, from SteamVR's steamvr.vrsettings file.
+///
+/// The file is parsed once, into a flat open-addressed hash table of typed
+/// values, so answering the driver's queries takes neither allocation nor
+/// I/O. Changes are written back to the file from a background thread, a
+/// moment after the last one (or right away on Sync()). Without a file
+/// loaded, it starts out empty and changes are kept in memory only.
+///
+/// Thread-safe.
 class VRSettings : public IVRSettings {
 
   public:
+    VRSettings();
+    /// Writes out any pending changes.
+    ~VRSettings();
+
+    VRSettings(VRSettings const &) = delete;
+    VRSettings &operator=(VRSettings const &) = delete;
+
+    /// Where SteamVR keeps its settings, given its root config dir.
+    static std::string getSettingsFile(std::string const &rootConfigDir);
+
+    /// Replace the contents with those of the given file, and write changes
+    /// back to it.
+    /// @return false if it was missing or couldn't be parsed, in which case
+    /// the settings start out empty and changes are kept in memory only, so
+    /// the file isn't overwritten with just those.
+    bool load(std::string const &fn);
+
     virtual const char *GetSettingsErrorNameFromEnum(EVRSettingsError eError);
 
-    // Returns true if file sync occurred (force or settings dirty)
+    // Returns true if a file sync was started: only when there are changes
+    // to write, forced or not.
     virtual bool Sync(bool bForce = false, EVRSettingsError *peError = nullptr);
 
     virtual bool GetBool(const char *pchSection, const char *pchSettingsKey,
@@ -71,6 +110,58 @@ class VRSettings : public IVRSettings {
     virtual void RemoveKeyInSection(const char *pchSection,
                                     const char *pchSettingsKey,
                                     EVRSettingsError *peError = nullptr);
+
+  private:
+    enum class ValueType : std::uint8_t {
+        /// Never used.
+        Empty,
+        /// Used, then removed: lookups keep probing past it.
+        Removed,
+        Bool,
+        Number,
+        String
+    };
+
+    struct Entry {
+        ValueType type = ValueType::Empty;
+        std::uint32_t hash = 0;
+        std::string section;
+        std::string key;
+        /// Bools and numbers alike.
+        double number = 0;
+        std::string string;
+    };
+
+    /// @name Require mutex_ to be held
+    /// @{
+    Entry const *find(const char *section, const char *key) const;
+    /// Find the entry, or claim an empty one for it.
+    Entry &insert(const char *section, const char *key);
+    void rehash(std::size_t capacity);
+    void markDirty();
+    /// @}
+
+    void writerThread();
+    void write(Json::Value const &root);
+
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+    /// Entries used, including removed ones.
+    std::size_t used_ = 0;
+    /// The parsed file, kept up to date with changes so what's written back
+    /// keeps anything it holds besides the simple values we index.
+    std::unique_ptr<Json::Value> root_;
+    std::string filename_;
+
+    /// @name Write-back state, mutex-controlled
+    /// @{
+    std::condition_variable wake_;
+    bool dirty_ = false;
+    bool syncRequested_ = false;
+    bool stopping_ = false;
+    /// Started on the first change.
+    std::thread writer_;
+    /// @}
 };
 
 #endif // INCLUDED_IVRSettings_h_GUID_138FAF71_763D_4499_62A1_BBD01F8F2567
@@ -22,8 +22,12 @@
 // Internal Includes
 #include "DriverWrapper.h"
 #include "InterfaceTraits.h"
+#include "Logger.h"
 #include "OSVRViveTracker.h"
+#include "PluginConfig.h"
 #include "ServerPropertyHelper.h"
+#include "StartupTimeline.h"
+#include "ThreadTuning.h"
 #include <osvr/PluginKit/PluginKit.h>
 #include <osvr/Util/PlatformConfig.h>
 
@@ -32,9 +36,10 @@
 #include <openvr_driver.h>
 
 // Standard includes
+#include <algorithm>
 #include <chrono>
 #include <deque>
-#include <iostream>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -43,13 +48,33 @@
 // Anonymous namespace to avoid symbol collision
 namespace {
 
-static const auto PREFIX = "[OSVR-Vive] ";
+using ConfigPtr = std::shared_ptr<osvr::vive::PluginConfig>;
+
+/// Receives the params of the optional "ViveConfig" driver entry. The server
+/// instantiates configured drivers before it first runs hardware detection, so
+/// this is in place by the time the Vive gets started.
+class ConfigInstantiation {
+  public:
+    explicit ConfigInstantiation(ConfigPtr const &config) : m_config(config) {}
+    OSVR_ReturnCode operator()(OSVR_PluginRegContext, const char *params) {
+        *m_config = osvr::vive::parsePluginConfig(params ? params : "");
+        osvr::vive::Logger::instance().setLevel(m_config->logLevel);
+        osvr::vive::configureThreads(m_config->pumpThread,
+                                     m_config->driverThreads,
+                                     m_config->workerThreads);
+        return OSVR_RETURN_SUCCESS;
+    }
+
+  private:
+    ConfigPtr m_config;
+};
 
 class HardwareDetection {
 
   public:
-    HardwareDetection()
-        : m_inactiveDriverHost(new osvr::vive::ViveDriverHost) {}
+    explicit HardwareDetection(ConfigPtr const &config)
+        : m_inactiveDriverHost(new osvr::vive::ViveDriverHost),
+          m_config(config) {}
     OSVR_ReturnCode operator()(OSVR_PluginRegContext ctx) {
         if (m_driverHost) {
             // Already found a Vive.
@@ -62,47 +87,127 @@ class HardwareDetection {
             return OSVR_RETURN_FAILURE;
         }
 
+        if (!m_pendingStartup.valid()) {
+            if (clock::now() < m_nextAttempt) {
+                /// Backing off after a failed attempt.
+                return OSVR_RETURN_FAILURE;
+            }
+            /// Loading the driver and waiting for it to find devices can take
+            /// a while (USB enumeration...), so do it in the background
+            /// rather than stall the server.
+            m_pendingStartup = std::async(
+                std::launch::async, [this] { return backgroundStartup(); });
+        }
+
+        /// Block the server only for a bounded while: the server doesn't
+        /// necessarily run detection again, so a detect that returns before
+        /// startup finishes may leave the Vive unregistered until it does.
+        auto wait = std::chrono::duration<double>(
+            m_config->detectWait > 0 ? m_config->detectWait : 0.);
+        if (m_pendingStartup.wait_for(wait) != std::future_status::ready) {
+            /// Still going: we'll pick it up on a later detect.
+            return OSVR_RETURN_FAILURE;
+        }
+        return finishDetection(ctx, m_pendingStartup.get());
+    }
+
+  private:
+    using clock = std::chrono::steady_clock;
+
+    enum class StartupResult {
+        /// Driver couldn't be loaded at all - give up for good.
+        NoDriver,
+        /// Trouble in early startup, or starting the driver.
+        Failed,
+        /// Driver loaded fine, but no Vive plugged in.
+        NotPresent,
+        /// Driver started, ready to register the OSVR device.
+        Started
+    };
+
+    /// Runs on the startup thread: the main thread leaves m_viveWrapper and
+    /// m_inactiveDriverHost alone until it's done.
+    StartupResult backgroundStartup() {
+        osvr::vive::OwnedThread thread("vive-startup");
+        osvr::vive::StartupTimeline::instance().reset();
         auto vivePtr = startupAndGetVive();
         if (!vivePtr) {
             /// There was trouble in early startup
-            return OSVR_RETURN_FAILURE;
+            return m_noDriver ? StartupResult::NoDriver
+                              : StartupResult::Failed;
         }
 
         if (!vivePtr->isHMDPresent()) {
             /// Didn't detect anything - leave the driver DLL loaded,
             /// though, to make things faster next time around.
-            /// Silent failure, to avoid annoying users.
-            return OSVR_RETURN_FAILURE;
+            return StartupResult::NotPresent;
         }
 
-        std::cout << PREFIX << "Vive is connected." << std::endl;
+        osvr::vive::logInfo() << "Vive is connected.";
 
         /// Hand the Vive object off to the OSVR driver.
-        auto startResult = finishViveStartup(ctx);
-        if (startResult) {
+        auto startResult =
+            getInactiveHost().startDriver(std::move(*m_viveWrapper), *m_config);
+        m_viveWrapper.reset();
+        return startResult ? StartupResult::Started : StartupResult::Failed;
+    }
+
+    /// Back on the server thread with the outcome of a startup attempt.
+    OSVR_ReturnCode finishDetection(OSVR_PluginRegContext ctx,
+                                    StartupResult result) {
+        switch (result) {
+        case StartupResult::Started:
+            m_inactiveDriverHost->registerDevice(ctx);
+            m_driverHost = std::move(m_inactiveDriverHost);
+            m_backoff = INITIAL_BACKOFF;
             /// and it started up the rest of the way just fine!
             /// We'll keep the driver around!
-            std::cout << PREFIX << "Vive driver finished startup successfully!"
-                      << std::endl;
+            osvr::vive::logInfo()
+                << "Vive driver finished startup successfully!";
+            reportStartupTimeline();
             return OSVR_RETURN_SUCCESS;
-        }
 
-        std::cout << PREFIX << "Vive driver startup failed somewhere, "
-                               "unloading to perhaps try again later."
-                  << std::endl;
+        case StartupResult::NoDriver:
+            stopAttemptingDetection();
+            return OSVR_RETURN_FAILURE;
+
+        case StartupResult::Failed:
+            osvr::vive::logWarn() << "Vive driver startup failed somewhere, "
+                                     "unloading to perhaps try again later.";
+            reportStartupTimeline();
+            unloadTemporaries();
+            backOff();
+            return OSVR_RETURN_FAILURE;
 
-        unloadTemporaries();
-        return OSVR_RETURN_FAILURE;
+        case StartupResult::NotPresent:
+        default:
+            /// Silent failure, to avoid annoying users.
+            backOff();
+            return OSVR_RETURN_FAILURE;
+        }
     }
 
-    bool finishViveStartup(OSVR_PluginRegContext ctx) {
-        auto startResult =
-            m_inactiveDriverHost->start(ctx, std::move(*m_viveWrapper));
-        m_viveWrapper.reset();
-        if (startResult) {
-            m_driverHost = std::move(m_inactiveDriverHost);
+    /// Print where the time went in the last startup attempt, and save it as
+    /// a trace if configured.
+    void reportStartupTimeline() {
+        auto &timeline = osvr::vive::StartupTimeline::instance();
+        osvr::vive::logInfo() << timeline.summary();
+        auto const &fn = m_config->startupTraceFile;
+        if (fn.empty()) {
+            return;
+        }
+        if (timeline.writeChromeTrace(fn)) {
+            osvr::vive::logInfo() << "Wrote startup trace to " << fn;
+        } else {
+            osvr::vive::logError() << "Could not write startup trace to " << fn;
         }
-        return startResult;
+    }
+
+    /// Don't attempt detection again for a while, waiting longer after each
+    /// consecutive failure.
+    void backOff() {
+        m_nextAttempt = clock::now() + m_backoff;
+        m_backoff = std::min(m_backoff * 2, MAX_BACKOFF);
     }
 
     /// Attempts the first part of startup, if required.
@@ -112,26 +217,25 @@ class HardwareDetection {
                 new osvr::vive::DriverWrapper(&getInactiveHost()));
 
             if (m_viveWrapper->foundDriver()) {
-                std::cout << PREFIX << "Found the Vive driver at "
-                          << m_viveWrapper->getDriverFileLocation()
-                          << std::endl;
+                osvr::vive::logInfo()
+                    << "Found the Vive driver at "
+                    << m_viveWrapper->getDriverFileLocation();
             }
 
             if (!m_viveWrapper->haveDriverLoaded()) {
-                std::cout << PREFIX << "Could not open driver." << std::endl;
-                stopAttemptingDetection();
+                osvr::vive::logInfo() << "Could not open driver.";
+                m_noDriver = true;
                 return nullptr;
             }
 
             if (m_viveWrapper->foundConfigDirs()) {
-                std::cout << PREFIX << "Driver config dir is: "
-                          << m_viveWrapper->getDriverConfigDir() << std::endl;
+                osvr::vive::logInfo() << "Driver config dir is: "
+                                      << m_viveWrapper->getDriverConfigDir();
             }
 
             if (!(*m_viveWrapper)) {
-                std::cerr << PREFIX
-                          << "Error in first-stage Vive driver startup."
-                          << std::endl;
+                osvr::vive::logError()
+                    << "Error in first-stage Vive driver startup.";
                 m_viveWrapper.reset();
                 return nullptr;
             }
@@ -153,8 +257,7 @@ class HardwareDetection {
     }
 
     void stopAttemptingDetection() {
-        std::cerr << PREFIX << "Will not re-attempt detecting Vive."
-                  << std::endl;
+        osvr::vive::logWarn() << "Will not re-attempt detecting Vive.";
         m_shouldAttemptDetection = false;
         unloadTemporaries();
         m_driverHost.reset();
@@ -165,9 +268,9 @@ class HardwareDetection {
         m_inactiveDriverHost.reset();
     }
 
-  private:
     /// This is the OSVR driver object, which also serves as the "SteamVR"
-    /// driver host. We can only run one Vive at a time.
+    /// driver host. There's only the one SteamVR driver per process, so
+    /// this one host drives every HMD (up to the maxHmds option).
     osvr::vive::DriverHostPtr m_driverHost;
 
     /// A Vive object that we hang on to if we don't have a fully-started-up
@@ -178,15 +281,39 @@ class HardwareDetection {
     /// hardware detect request.
     osvr::vive::DriverHostPtr m_inactiveDriverHost;
 
+    /// Shared with the ConfigInstantiation callback.
+    ConfigPtr m_config;
+
+    /// The startup attempt running in the background, if any.
+    std::future<StartupResult> m_pendingStartup;
+    /// Set by the startup thread if the driver couldn't be opened.
+    bool m_noDriver = false;
+
+    static const clock::duration INITIAL_BACKOFF;
+    static const clock::duration MAX_BACKOFF;
+    clock::duration m_backoff = INITIAL_BACKOFF;
+    clock::time_point m_nextAttempt;
+
     bool m_shouldAttemptDetection = true;
 };
+
+const HardwareDetection::clock::duration HardwareDetection::INITIAL_BACKOFF =
+    std::chrono::seconds(1);
+const HardwareDetection::clock::duration HardwareDetection::MAX_BACKOFF =
+    std::chrono::seconds(60);
 } // namespace
 
 OSVR_PLUGIN(com_osvr_Vive) {
     osvr::pluginkit::PluginContext context(ctx);
 
+    auto config = std::make_shared<osvr::vive::PluginConfig>();
+
+    /// Register a callback for the optional config entry.
+    context.registerDriverInstantiationCallback(
+        osvr::vive::CONFIG_DRIVER_NAME, ConfigInstantiation(config));
+
     /// Register a detection callback function object.
-    context.registerHardwareDetectCallback(new HardwareDetection());
+    context.registerHardwareDetectCallback(new HardwareDetection(config));
 
     return OSVR_RETURN_SUCCESS;
 }